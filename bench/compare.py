@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Compares benchmark results against a baseline and flags regressions.
+
+Usage: compare.py [--threshold PERCENT] BASELINE CURRENT
+
+BASELINE and CURRENT are JSON files written by a benchmark with `--json`
+or directories of such files. Exits with 1 if any benchmark got slower by
+more than the threshold or allocates more per operation.
+"""
+
+import json
+import os
+import sys
+
+
+def load(path):
+    paths = [path]
+    if os.path.isdir(path):
+        paths = sorted(
+            os.path.join(path, name)
+            for name in os.listdir(path)
+            if name.endswith(".json")
+        )
+
+    results = {}
+    for p in paths:
+        with open(p) as file:
+            for result in json.load(file):
+                results[result["name"]] = result
+    return results
+
+
+def main(argv):
+    threshold = 10.0
+    if len(argv) > 2 and argv[1] == "--threshold":
+        threshold = float(argv[2])
+        argv = argv[:1] + argv[3:]
+    if len(argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    baseline = load(argv[1])
+    current = load(argv[2])
+
+    regressions = 0
+    print(f"{'benchmark':<60} {'base ns':>12} {'ns':>12} {'change':>8}")
+    for name, cur in current.items():
+        base = baseline.get(name)
+        if base is None:
+            print(f"{name:<60} {'-':>12} {cur['ns_per_op']:>12.1f} {'new':>8}")
+            continue
+
+        change = (cur["ns_per_op"] / base["ns_per_op"] - 1.0) * 100.0
+        flags = []
+        if change > threshold:
+            flags.append("SLOWER")
+        if cur["allocs_per_op"] > base["allocs_per_op"] + 0.005:
+            flags.append(
+                f"ALLOCS {base['allocs_per_op']:.2f}"
+                f" -> {cur['allocs_per_op']:.2f}"
+            )
+        regressions += bool(flags)
+
+        print(
+            f"{name:<60} {base['ns_per_op']:>12.1f} {cur['ns_per_op']:>12.1f}"
+            f" {change:>+7.1f}% {' '.join(flags)}"
+        )
+
+    for name in baseline.keys() - current.keys():
+        print(f"{name:<60} missing from current results")
+
+    print(f"{regressions} regression(s), threshold {threshold:.1f}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,158 @@
+// Measures every component on the render and poll paths over the corpus
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "backend.h"
+#include "cpu.h"
+#include "formatter.h"
+#include "framer.h"
+#include "history.h"
+#include "parse.h"
+#include "rate_curve.h"
+#include "render_table.h"
+#include "smoother.h"
+
+static float _load(uint64_t i)
+{
+    return static_cast<float>(i * 37 % 101) / 100.0f;
+}
+
+int main(int argc, char** argv)
+{
+    pcat::bench::harness harness(argc, argv);
+
+    std::vector<std::string> frames =
+        pcat::bench::corpus_lines("bench/corpus/frames");
+
+    for (const char* stat : { "stat-4", "stat-64" })
+    {
+        pcat::cpu cpu(std::string("bench/corpus/") + stat);
+        harness.run(std::string("cpu/poll/") + stat,
+            [&](uint64_t)
+            {
+                float load = cpu.poll().value_or(0.0f);
+                pcat::bench::keep(load);
+            });
+    }
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        std::string name = "frames-" + std::to_string(i);
+
+        harness.run("framer/set/" + name,
+            [&](uint64_t)
+            {
+                pcat::framer framer;
+                framer.set(frames[i]);
+                pcat::bench::keep(framer);
+            });
+
+        pcat::framer framer;
+        framer.set(frames[i]);
+        harness.run("framer/get/" + name,
+            [&](uint64_t)
+            {
+                framer.next();
+                std::string_view frame = framer.get();
+                pcat::bench::keep(frame);
+            });
+    }
+
+    for (const std::string& kernel : { pcat::smoother::LINEAR_KERNEL,
+             pcat::smoother::EMA_KERNEL, pcat::smoother::SPRING_KERNEL })
+    {
+        pcat::smoother smoother(500, kernel);
+        auto now = std::chrono::steady_clock::now();
+        harness.run("smoother/value/" + kernel,
+            [&](uint64_t i)
+            {
+                now += std::chrono::milliseconds(33);
+                smoother.target(_load(i / 16));
+                float value = smoother.value(now);
+                pcat::bench::keep(value);
+            });
+    }
+
+    for (const std::string& curve : { pcat::rate_curve::LINEAR_CURVE,
+             pcat::rate_curve::LOG_CURVE, std::string("0:2 50:10 100:30") })
+    {
+        pcat::rate_curve rate_curve;
+        rate_curve.set(curve, 2, 30);
+        harness.run("rate_curve/period/" + curve,
+            [&](uint64_t i)
+            {
+                std::chrono::nanoseconds period = rate_curve.period(_load(i));
+                pcat::bench::keep(period);
+            });
+    }
+
+    {
+        pcat::history history(1800, 8);
+        pcat::history::stats stats;
+        harness.run("history/push",
+            [&](uint64_t i)
+            { history.push(static_cast<uint8_t>(i * 37 % 101)); });
+        harness.run("history/get",
+            [&](uint64_t)
+            {
+                history.get(stats);
+                pcat::bench::keep(stats);
+            });
+    }
+
+    for (const std::string& output :
+        { pcat::backend::PLAIN, pcat::backend::WAYBAR, pcat::backend::I3BAR })
+    {
+        pcat::framer framer;
+        framer.set(frames[0]);
+        pcat::formatter formatter;
+        formatter.set("$frame $rcpu");
+        pcat::backend backend(output);
+        pcat::render_table table(framer, formatter, backend, false);
+
+        harness.run("render_table/get/" + output,
+            [&](uint64_t i)
+            {
+                std::string_view line =
+                    table.get(i % framer.count(), i * 37 % 101);
+                pcat::bench::keep(line);
+            });
+
+        std::string line;
+        line.reserve(256);
+        harness.run("backend/serialize/" + output,
+            [&](uint64_t i)
+            {
+                line.clear();
+                backend.serialize(line,
+                    { framer.at(i % framer.count()),
+                        static_cast<uint8_t>(i * 37 % 101), false });
+                pcat::bench::keep(line);
+            });
+    }
+
+    for (const char* conf : { "res/polycat-config" })
+    {
+        harness.run(std::string("parse/load/") + conf,
+            [&](uint64_t)
+            {
+                pcat::parse parse;
+                std::vector<pcat::parse::err> errs = parse.load(conf);
+                pcat::bench::keep(errs);
+            });
+    }
+
+    harness.run("parse/load_embedded",
+        [&](uint64_t)
+        {
+            pcat::parse parse;
+            std::vector<pcat::parse::err> errs = parse.load_embedded();
+            pcat::bench::keep(errs);
+        });
+
+    return harness.finish();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Configs for benchmarks: the built-in config with some keys replaced
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "embedded_conf.h"
+
+namespace pcat::bench
+{
+
+    using overrides =
+        std::vector<std::pair<std::string_view, std::string_view>>;
+
+    /**
+     * @brief Writes the built-in config with the keys replaced
+     * @return true - on success, false - otherwise
+     */
+    inline bool write_conf(const std::string& path, const overrides& keys)
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        const embedded_conf::entries& entries = embedded_conf::get();
+        for (size_t i = 0; i < entries.count; i++)
+        {
+            std::string_view key = entries.list[i].key;
+            std::string_view value = entries.list[i].value;
+            for (const auto& [override_key, override_value] : keys)
+            {
+                if (override_key == key)
+                {
+                    value = override_value;
+                }
+            }
+            std::fprintf(file, "%.*s = %.*s\n", static_cast<int>(key.size()),
+                key.data(), static_cast<int>(value.size()), value.data());
+        }
+
+        return std::fclose(file) == 0;
+    }
+
+}
@@ -0,0 +1,105 @@
+// Compares the compiled formatter against the replace_all based one it
+// replaced
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "formatter.h"
+#include "framer.h"
+#include "gradient.h"
+#include "history.h"
+
+static void _replace_all(std::string& string, const std::string& substring_old,
+    const std::string& substring_new) noexcept
+{
+    std::string::size_type pos = 0;
+    while ((pos = string.find(substring_old, pos)) != std::string::npos)
+    {
+        string.replace(pos, substring_old.length(), substring_new);
+        pos += substring_new.length();
+    }
+}
+
+static std::string _legacy_format(
+    const std::string& format, const std::string& frame, uint8_t load)
+{
+    std::string result = format;
+
+    std::string r_load_string =
+        std::to_string(static_cast<uint32_t>(load)) + std::string("%");
+    std::string l_load_string = r_load_string;
+
+    while (l_load_string.length() < 4 && r_load_string.length() < 4)
+    {
+        r_load_string = " " + r_load_string;
+        l_load_string = l_load_string + " ";
+    }
+
+    _replace_all(result, "$$", "$");
+    _replace_all(result, "$frame", frame);
+    _replace_all(result, "$rcpu", r_load_string);
+    _replace_all(result, "$lcpu", l_load_string);
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    pcat::bench::harness harness(argc, argv);
+
+    std::vector<std::string> frames =
+        pcat::bench::corpus_lines("bench/corpus/frames");
+    std::vector<std::string> formats =
+        pcat::bench::corpus_lines("bench/corpus/formats");
+
+    pcat::framer framer;
+    framer.set(frames[0]);
+
+    pcat::gradient gradient;
+    gradient.set("#00ff00 #ffff00 #ff0000", pcat::gradient::POLYBAR_MARKUP);
+
+    pcat::history history(60, 8);
+    pcat::history::stats stats;
+    for (uint64_t i = 0; i < 60; i++)
+    {
+        history.push(static_cast<uint8_t>(i * 37 % 101));
+    }
+    history.get(stats);
+
+    for (const std::string& format : formats)
+    {
+        std::string frame(framer.at(0));
+
+        pcat::formatter formatter;
+        gradient.add_keys(formatter);
+        pcat::history::add_keys(formatter, stats);
+        formatter.set(format);
+        std::string line;
+        line.reserve(256);
+
+        // The legacy formatter only knows the frame and load keys
+        formatter.format(line, { frame, 0 });
+        if (line == _legacy_format(format, frame, 0))
+        {
+            harness.run("formatter/legacy/" + format,
+                [&](uint64_t i)
+                {
+                    std::string line = _legacy_format(format, frame, i % 101);
+                    pcat::bench::keep(line);
+                });
+        }
+
+        harness.run("formatter/compiled/" + format,
+            [&](uint64_t i)
+            {
+                uint8_t load = static_cast<uint8_t>(i % 101);
+                line.clear();
+                formatter.format(line, { framer.at(i % framer.count()), load });
+                pcat::bench::keep(line);
+            });
+    }
+
+    return harness.finish();
+}
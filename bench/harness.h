@@ -0,0 +1,305 @@
+#pragma once
+
+// Benchmark harness: warmup, repetitions, ns/op, allocations/op, allocated
+// bytes/op and JSON output. Replaces global operator new to count
+// allocations, so it must be included by exactly one translation unit, which
+// every benchmark is. With POLYCAT_ALLOC_AUDIT the audit hook already
+// replaces it and its totals are used instead.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "alloc_audit.h"
+
+namespace pcat::bench
+{
+
+    inline std::atomic<uint64_t> allocs = 0;
+
+    inline std::atomic<uint64_t> alloc_bytes = 0;
+
+    /**
+     * @brief Tells the number of allocations made by the process so far
+     */
+    inline uint64_t alloc_count() noexcept
+    {
+        if constexpr (alloc_audit::ENABLED)
+        {
+            return alloc_audit::total_allocs();
+        }
+        return allocs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Tells the number of bytes allocated by the process so far
+     */
+    inline uint64_t alloc_byte_count() noexcept
+    {
+        if constexpr (alloc_audit::ENABLED)
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i < alloc_audit::PHASE_COUNT; i++)
+            {
+                total += alloc_audit::bytes(static_cast<alloc_audit::phase>(i));
+            }
+            return total;
+        }
+        return alloc_bytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Keeps the compiler from optimizing the value away
+     */
+    template<typename T>
+    inline void keep(T&& value) noexcept
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * @brief Reads lines of a corpus file
+     */
+    inline std::vector<std::string> corpus_lines(const std::string& path)
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            lines.push_back(line);
+        }
+        if (lines.empty())
+        {
+            std::fprintf(stderr, "Corpus file `%s` is missing or empty\n",
+                path.c_str());
+            std::exit(EXIT_FAILURE);
+        }
+        return lines;
+    }
+
+    /**
+     * @brief Runs benchmarks and reports their results
+     *
+     * Arguments: `--json <path>` writes results as JSON, `--filter <text>`
+     * runs only benchmarks with names containing text.
+     */
+    class harness
+    {
+    public:
+        static constexpr int REPETITIONS = 5;
+
+        // Iterations of a repetition are increased until it takes this long
+        static constexpr std::chrono::milliseconds MIN_TIME { 20 };
+
+        /**
+         * @brief Result of a benchmark, median of the repetitions
+         */
+        struct result
+        {
+            std::string name;
+            uint64_t iterations;
+            double ns_per_op;
+            double min_ns_per_op;
+            double allocs_per_op;
+            double bytes_per_op;
+        };
+
+        harness(int argc, char** argv) :
+            m_json(),
+            m_filter(),
+            m_results()
+        {
+            for (int i = 1; i + 1 < argc; i += 2)
+            {
+                if (std::strcmp(argv[i], "--json") == 0)
+                {
+                    m_json = argv[i + 1];
+                }
+                else if (std::strcmp(argv[i], "--filter") == 0)
+                {
+                    m_filter = argv[i + 1];
+                }
+            }
+        }
+
+        /**
+         * @brief Tells if the benchmark passes the filter
+         */
+        bool enabled(const std::string& name) const
+        {
+            return name.find(m_filter) != std::string::npos;
+        }
+
+        /**
+         * @brief Measures f(i) for i counting from 0
+         * @param name Benchmark name, `component/case`
+         * @param f Operation
+         */
+        template<typename F>
+        void run(const std::string& name, F f)
+        {
+            using namespace std::chrono;
+
+            if (!enabled(name))
+            {
+                return;
+            }
+
+            // Calibrate, doubles as warmup
+            uint64_t iterations = 1;
+            while (_time(f, iterations) < MIN_TIME &&
+                   iterations < (uint64_t(1) << 40))
+            {
+                iterations *= 2;
+            }
+
+            std::vector<double> samples;
+            uint64_t allocs_start = alloc_count();
+            uint64_t bytes_start = alloc_byte_count();
+            for (int r = 0; r < REPETITIONS; r++)
+            {
+                samples.push_back(
+                    duration<double, std::nano>(_time(f, iterations))
+                        .count() /
+                    static_cast<double>(iterations));
+            }
+            uint64_t allocs_end = alloc_count();
+            uint64_t bytes_end = alloc_byte_count();
+
+            double ops = static_cast<double>(iterations * REPETITIONS);
+            std::sort(samples.begin(), samples.end());
+            report({ name, iterations, samples[REPETITIONS / 2], samples[0],
+                static_cast<double>(allocs_end - allocs_start) / ops,
+                static_cast<double>(bytes_end - bytes_start) / ops });
+        }
+
+        /**
+         * @brief Reports a result measured elsewhere
+         */
+        void report(const result& result)
+        {
+            if (m_results.empty())
+            {
+                std::printf("%-60s %12s %12s %10s %10s\n", "benchmark",
+                    "ns/op", "min ns/op", "allocs/op", "bytes/op");
+            }
+            std::printf("%-60s %12.1f %12.1f %10.2f %10.1f\n",
+                result.name.c_str(), result.ns_per_op, result.min_ns_per_op,
+                result.allocs_per_op, result.bytes_per_op);
+            std::fflush(stdout);
+            m_results.push_back(result);
+        }
+
+        /**
+         * @brief Tells results reported so far
+         */
+        const std::vector<result>& results() const { return m_results; }
+
+        /**
+         * @brief Writes JSON output if requested
+         * @return Exit code
+         */
+        int finish() const
+        {
+            if (m_json.empty())
+            {
+                return EXIT_SUCCESS;
+            }
+
+            FILE* file = std::fopen(m_json.c_str(), "w");
+            if (file == nullptr)
+            {
+                std::fprintf(stderr, "Failed to open `%s`\n", m_json.c_str());
+                return EXIT_FAILURE;
+            }
+
+            std::fprintf(file, "[\n");
+            for (size_t i = 0; i < m_results.size(); i++)
+            {
+                const result& r = m_results[i];
+                std::fprintf(file,
+                    "  {\"name\": \"%s\", \"iterations\": %llu, "
+                    "\"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, "
+                    "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.3f}%s\n",
+                    _escape(r.name).c_str(),
+                    static_cast<unsigned long long>(r.iterations), r.ns_per_op,
+                    r.min_ns_per_op, r.allocs_per_op, r.bytes_per_op,
+                    i + 1 < m_results.size() ? "," : "");
+            }
+            std::fprintf(file, "]\n");
+
+            return std::fclose(file) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+    private:
+        std::string m_json;
+        std::string m_filter;
+        std::vector<result> m_results;
+
+        template<typename F>
+        static std::chrono::nanoseconds _time(F& f, uint64_t iterations)
+        {
+            using namespace std::chrono;
+
+            auto start = steady_clock::now();
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                f(i);
+            }
+            return duration_cast<nanoseconds>(steady_clock::now() - start);
+        }
+
+        static std::string _escape(const std::string& s)
+        {
+            std::string result;
+            for (char ch : s)
+            {
+                if (ch == '"' || ch == '\\')
+                {
+                    result.push_back('\\');
+                }
+                result.push_back(ch);
+            }
+            return result;
+        }
+    };
+
+}
+
+#ifndef POLYCAT_ALLOC_AUDIT
+
+void* operator new(std::size_t size)
+{
+    pcat::bench::allocs.fetch_add(1, std::memory_order_relaxed);
+    pcat::bench::alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+#if __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#endif
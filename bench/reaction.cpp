@@ -0,0 +1,232 @@
+// Measures how long the cat takes to speed up after a load step: time from
+// the step until a frame interval reaches 90% of the target frame rate.
+// Runs the pipeline on virtual time, so a trial takes microseconds and
+// trials differ only in the phase of the step against the poll and frame
+// schedules. Latencies are reported in place of ns/op, so bench-compare
+// flags regressions.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "harness.h"
+#include "configs.h"
+#include "clock.h"
+#include "conf.h"
+#include "counters.h"
+#include "history.h"
+#include "output.h"
+#include "pipeline.h"
+#include "plan.h"
+#include "rate_poll.h"
+
+static constexpr int TRIALS = 500;
+
+static constexpr float LOW_LOAD = 0.05f;
+
+static constexpr float HIGH_LOAD = 0.9f;
+
+static constexpr float TARGET_RATE_SHARE = 0.9f;
+
+// Long enough for the smoother and the frame schedule to settle at the low
+// load, the step happens at a random time within the jitter after it
+static constexpr std::chrono::seconds SETTLE { 15 };
+
+static constexpr std::chrono::milliseconds STEP_JITTER { 5'000 };
+
+static constexpr std::chrono::seconds TIMEOUT { 60 };
+
+/**
+ * @brief Case name and config keys replacing the built-in config ones
+ */
+struct reaction_case
+{
+    const char* name;
+    pcat::bench::overrides keys;
+};
+
+/**
+ * @brief Runs one step trial
+ * @param plan Resolved config
+ * @param step Time of the step since the start
+ * @return Time from the step to the first frame fast enough, TIMEOUT if
+ * there was none
+ */
+static std::chrono::nanoseconds _trial(
+    std::unique_ptr<const pcat::plan> plan, std::chrono::nanoseconds step)
+{
+    using namespace std::chrono;
+    using time_point = pcat::clock::time_point;
+
+    nanoseconds target_interval = duration_cast<nanoseconds>(
+        plan->rate_curve.period(HIGH_LOAD) / TARGET_RATE_SHARE);
+    nanoseconds reaction = TIMEOUT;
+    time_point step_point = time_point() + step;
+
+    pcat::history::stats history_stats;
+    pcat::counters counters;
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    pcat::output output(fd);
+    output.open();
+
+    pcat::virtual_clock clock { time_point() };
+    pcat::rate_poll rate_poll(plan->poll_period, "",
+        plan->history_samples(false), plan->spark_length, clock, nullptr,
+        nullptr, nullptr, nullptr);
+    pcat::pipeline pipeline(
+        rate_poll, output, history_stats, clock, &counters, nullptr);
+
+    uint64_t frames = 0;
+    time_point last_frame;
+    clock.observe(
+        [&](time_point now)
+        {
+            uint64_t curr = counters.frames.load(std::memory_order_relaxed);
+            if (curr == frames)
+            {
+                return;
+            }
+
+            if (frames != 0 && now >= step_point &&
+                now - last_frame <= target_interval)
+            {
+                reaction = now - step_point;
+                pipeline.stop();
+            }
+            frames = curr;
+            last_frame = now;
+        });
+
+    milliseconds period(plan->poll_period);
+    auto poll = [&](time_point now)
+    {
+        if (now > step_point + TIMEOUT)
+        {
+            pipeline.stop();
+            return time_point::max();
+        }
+
+        // Like a stat file, a poll tells the load averaged since the last one
+        nanoseconds high = std::clamp<nanoseconds>(
+            now - step_point, nanoseconds(0), period);
+        float share = duration<float>(high) / duration<float>(period);
+        rate_poll.sample(LOW_LOAD + (HIGH_LOAD - LOW_LOAD) * share);
+        return now + period;
+    };
+    clock.schedule(poll(time_point()), poll);
+
+    pipeline.run(std::move(plan));
+    close(fd);
+
+    return reaction;
+}
+
+int main(int argc, char** argv)
+{
+    using namespace std::chrono;
+
+    pcat::bench::harness harness(argc, argv);
+
+    const std::vector<reaction_case> cases = {
+        { "default", {} },
+        { "poll-250", { { "poll_period", "250" } } },
+        { "smoothing-500", { { "smoothing_value", "500" } } },
+        { "ema", { { "smoothing_kernel", "\"ema\"" } } },
+        { "spring", { { "smoothing_kernel", "\"spring\"" } } },
+        { "no-smoothing", { { "smoothing_enabled", "false" } } },
+        { "no-sleeping", { { "sleeping_enabled", "false" } } },
+        { "poll-250-no-smoothing",
+            {
+                { "poll_period", "250" },
+                { "smoothing_enabled", "false" },
+            } },
+    };
+
+    char dir[] = "/tmp/polycat-bench-reaction-XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        std::fprintf(stderr, "Failed to create temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string conf_path = std::string(dir) + "/polycat-config";
+
+    std::printf("%-40s %10s %10s %10s %8s\n", "case", "p50 ms", "p99 ms",
+        "max ms", "timeouts");
+
+    std::vector<std::pair<std::string, std::vector<nanoseconds>>> results;
+    for (const reaction_case& c : cases)
+    {
+        std::string name = std::string("reaction/") + c.name;
+        if (!harness.enabled(name))
+        {
+            continue;
+        }
+
+        pcat::conf conf(conf_path);
+        if (!pcat::bench::write_conf(conf_path, c.keys) || conf.load().any())
+        {
+            std::fprintf(stderr, "%s: invalid config\n", c.name);
+            return EXIT_FAILURE;
+        }
+
+        // Same step phases for every case
+        std::mt19937_64 random(1);
+        std::uniform_int_distribution<int64_t> jitter(
+            0, duration_cast<microseconds>(STEP_JITTER).count());
+
+        std::vector<nanoseconds> latencies;
+        int timeouts = 0;
+        for (int i = 0; i < TRIALS; i++)
+        {
+            pcat::history::stats history_stats;
+            pcat::plan::fmt_err err;
+            auto plan = pcat::plan::make(conf, history_stats, err);
+            if (plan == nullptr)
+            {
+                std::fprintf(stderr, "%s: %s\n", c.name, err.message.c_str());
+                return EXIT_FAILURE;
+            }
+            nanoseconds latency =
+                _trial(std::move(plan), SETTLE + microseconds(jitter(random)));
+            timeouts += latency >= TIMEOUT ? 1 : 0;
+            latencies.push_back(latency);
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        auto percentile = [&](size_t p)
+        { return latencies[(latencies.size() - 1) * p / 100]; };
+        auto ms = [](nanoseconds ns)
+        { return duration<double, std::milli>(ns).count(); };
+
+        std::printf("%-40s %10.1f %10.1f %10.1f %8d\n", name.c_str(),
+            ms(percentile(50)), ms(percentile(99)), ms(latencies.back()),
+            timeouts);
+        results.emplace_back(name, latencies);
+    }
+    std::printf("\n");
+
+    unlink(conf_path.c_str());
+    rmdir(dir);
+
+    for (const auto& [name, latencies] : results)
+    {
+        for (size_t p : { 50, 99 })
+        {
+            double ns = static_cast<double>(
+                latencies[(latencies.size() - 1) * p / 100].count());
+            harness.report({ name + "/p" + std::to_string(p),
+                latencies.size(), ns, ns, 0.0, 0.0 });
+        }
+    }
+
+    return harness.finish();
+}
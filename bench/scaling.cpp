@@ -0,0 +1,88 @@
+// Measures how sampling scales with the CPU count over generated stat files.
+// Every sampler mode gets its own case name, cpu::poll() reading the first
+// line with read(2) into a stack buffer is the only mode so far.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "harness.h"
+#include "stat_gen.h"
+#include "cpu.h"
+
+int main(int argc, char** argv)
+{
+    pcat::bench::harness harness(argc, argv);
+
+    const uint64_t cpu_counts[] = { 2, 64, 512, 1024 };
+
+    char dir[] = "/tmp/polycat-bench-scaling-XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        std::fprintf(stderr, "Failed to create temporary directory\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> paths;
+    std::vector<size_t> sizes;
+
+    for (uint64_t cpus : cpu_counts)
+    {
+        // Interrupt vectors grow with the CPU count on large machines
+        pcat::bench::stat_gen gen({ cpus, 64 + cpus * 4, 10, cpus });
+        gen.step(0.5f, 100);
+
+        std::string path = std::string(dir) + "/stat-" + std::to_string(cpus);
+        if (!gen.write(path))
+        {
+            std::fprintf(stderr, "Failed to write `%s`\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        paths.push_back(path);
+        sizes.push_back(gen.render().size());
+
+        pcat::cpu cpu(path);
+        harness.run("scaling/cpu-poll/cpus-" + std::to_string(cpus),
+            [&](uint64_t)
+            {
+                float load = cpu.poll().value_or(0.0f);
+                pcat::bench::keep(load);
+            });
+    }
+
+    for (const std::string& path : paths)
+    {
+        unlink(path.c_str());
+    }
+    rmdir(dir);
+
+    // Exponent of 1 is linear growth with the CPU count
+    const std::vector<pcat::bench::harness::result>& results =
+        harness.results();
+    if (results.size() == std::size(cpu_counts))
+    {
+        std::printf("\n%-8s %12s %12s %12s %10s\n", "cpus", "stat bytes",
+            "ns/sample", "bytes/sample", "exponent");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            double exponent = 0.0;
+            if (i > 0)
+            {
+                exponent = std::log(results[i].ns_per_op /
+                                    results[i - 1].ns_per_op) /
+                           std::log(static_cast<double>(cpu_counts[i]) /
+                                    static_cast<double>(cpu_counts[i - 1]));
+            }
+            std::printf("%-8llu %12zu %12.1f %12.1f %10.2f\n",
+                static_cast<unsigned long long>(cpu_counts[i]), sizes[i],
+                results[i].ns_per_op, results[i].bytes_per_op, exponent);
+        }
+    }
+
+    return harness.finish();
+}
@@ -0,0 +1,156 @@
+// Measures the time from exec to the first frame read from polycat stdout,
+// with the built-in config and with the config file, `POLYCAT` environment
+// variable overrides the binary
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+static const char* _make_stat(char* path)
+{
+    int fd = mkstemp(path);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+    const char line[] = "cpu  100 0 0 100 0 0 0\n";
+    bool ok = write(fd, line, sizeof(line) - 1) == sizeof(line) - 1;
+    close(fd);
+    return ok ? path : nullptr;
+}
+
+// Spawns polycat and returns nanoseconds until the first byte of output
+static double _startup_ns(char* const* argv, char* const* envp)
+{
+    using namespace std::chrono;
+
+    int fds[2];
+    if (pipe(fds) == -1)
+    {
+        return -1;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    auto start = steady_clock::now();
+
+    pid_t pid;
+    int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv, envp);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err != 0)
+    {
+        close(fds[0]);
+        return -1;
+    }
+
+    char ch;
+    ssize_t n = read(fds[0], &ch, 1);
+    auto end = steady_clock::now();
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    close(fds[0]);
+
+    return n == 1 ? duration<double, std::nano>(end - start).count() : -1;
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = 200;
+    pcat::bench::harness harness(argc, argv);
+    const char* polycat_env = std::getenv("POLYCAT");
+    std::string polycat =
+        polycat_env != nullptr ? polycat_env : "build/polycat";
+
+    char stat_path[] = "/tmp/polycat-bench-stat-XXXXXX";
+    char home_path[] = "/tmp/polycat-bench-home-XXXXXX";
+    if (_make_stat(stat_path) == nullptr || mkdtemp(home_path) == nullptr)
+    {
+        std::fprintf(stderr, "Failed to create temporary files\n");
+        return EXIT_FAILURE;
+    }
+
+    // Empty home makes polycat fall back to the built-in config
+    std::string home = std::string("HOME=") + home_path;
+    char* envp[] = { home.data(), nullptr };
+
+    char* builtin_argv[] = {
+        polycat.data(),
+        const_cast<char*>("-s"),
+        stat_path,
+        nullptr,
+    };
+    char* file_argv[] = {
+        polycat.data(),
+        const_cast<char*>("-s"),
+        stat_path,
+        const_cast<char*>("-c"),
+        const_cast<char*>("res/polycat-config"),
+        nullptr,
+    };
+
+    struct
+    {
+        std::string name;
+        char** argv;
+        std::vector<double> samples;
+    } cases[] = {
+        { "startup/built-in-config", builtin_argv, {} },
+        { "startup/config-file", file_argv, {} },
+    };
+
+    // Interleaved so both cases see the same system state
+    for (int i = 0; i < runs; i++)
+    {
+        for (auto& c : cases)
+        {
+            if (!harness.enabled(c.name))
+            {
+                continue;
+            }
+
+            double ns = _startup_ns(c.argv, envp);
+            if (ns < 0)
+            {
+                std::fprintf(stderr, "Failed to run `%s`\n", polycat.c_str());
+                return EXIT_FAILURE;
+            }
+            c.samples.push_back(ns);
+        }
+    }
+
+    unlink(stat_path);
+    rmdir(home_path);
+
+    // Allocations happen in the child and are not counted
+    for (auto& c : cases)
+    {
+        if (c.samples.empty())
+        {
+            continue;
+        }
+        std::sort(c.samples.begin(), c.samples.end());
+        harness.report({ c.name, c.samples.size(),
+            c.samples[c.samples.size() / 2], c.samples[0], 0.0, 0.0 });
+    }
+
+    return harness.finish();
+}
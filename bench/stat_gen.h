@@ -0,0 +1,202 @@
+#pragma once
+
+// Generates /proc/stat contents for machines of any size, counters evolve
+// with the simulated load
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace pcat::bench
+{
+
+    class stat_gen
+    {
+    public:
+        // Fields of a cpu line: user nice system idle iowait irq softirq
+        // steal guest guest_nice
+        static constexpr size_t CPU_FIELDS = 10;
+
+        struct params
+        {
+            uint64_t cpus;
+            uint64_t intr;
+            uint64_t softirq;
+            uint64_t seed;
+        };
+
+        /**
+         * @brief Constructs a generator with counters of a machine that has
+         * been up for a while, so numbers have realistic widths
+         */
+        stat_gen(const params& params) :
+            m_params(params),
+            m_random(params.seed),
+            m_cpus(params.cpus * CPU_FIELDS),
+            m_intr(params.intr),
+            m_softirq(params.softirq),
+            m_ctxt(0),
+            m_processes(0)
+        {
+            for (uint64_t cpu = 0; cpu < params.cpus; cpu++)
+            {
+                uint64_t* fields = &m_cpus[cpu * CPU_FIELDS];
+                fields[0] = _random(100'000, 9'000'000);
+                fields[1] = _random(0, 50'000);
+                fields[2] = _random(20'000, 2'000'000);
+                fields[3] = _random(1'000'000, 90'000'000);
+                fields[4] = _random(100, 90'000);
+                fields[5] = _random(0, 30'000);
+                fields[6] = _random(100, 90'000);
+            }
+            // Most interrupt lines are unused
+            for (uint64_t& count : m_intr)
+            {
+                count = _random(0, 3) == 0 ? _random(1, 10'000'000) : 0;
+            }
+            for (uint64_t& count : m_softirq)
+            {
+                count = _random(0, 100'000'000);
+            }
+            m_ctxt = _random(100'000'000, 10'000'000'000);
+            m_processes = _random(100'000, 10'000'000);
+        }
+
+        /**
+         * @brief Advances counters by a number of jiffies at specified load
+         * @param load Value in range [0-1]
+         * @param jiffies Jiffies elapsed on every CPU
+         */
+        void step(float load, uint64_t jiffies)
+        {
+            for (uint64_t cpu = 0; cpu < m_params.cpus; cpu++)
+            {
+                uint64_t* fields = &m_cpus[cpu * CPU_FIELDS];
+
+                // CPUs are loaded unevenly around the requested load
+                float jitter =
+                    static_cast<float>(_random(0, 200)) / 1000.0f - 0.1f;
+                float cpu_load = std::clamp(load + jitter, 0.0f, 1.0f);
+                uint64_t work = static_cast<uint64_t>(
+                    cpu_load * static_cast<float>(jiffies) + 0.5f);
+                uint64_t system = work / 4;
+
+                fields[0] += work - system;
+                fields[2] += system;
+                fields[3] += jiffies - work;
+            }
+            for (uint64_t& count : m_intr)
+            {
+                count += count != 0 ? _random(0, jiffies * 4) : 0;
+            }
+            for (uint64_t& count : m_softirq)
+            {
+                count += _random(0, jiffies * 8);
+            }
+            m_ctxt += _random(0, jiffies * m_params.cpus * 50);
+            m_processes += _random(0, 2);
+        }
+
+        /**
+         * @brief Renders the stat file contents
+         */
+        std::string render() const
+        {
+            std::string out;
+            out.reserve(m_params.cpus * 96 + m_intr.size() * 4 + 256);
+
+            std::vector<uint64_t> total(CPU_FIELDS, 0);
+            for (uint64_t cpu = 0; cpu < m_params.cpus; cpu++)
+            {
+                for (size_t i = 0; i < CPU_FIELDS; i++)
+                {
+                    total[i] += m_cpus[cpu * CPU_FIELDS + i];
+                }
+            }
+
+            out += "cpu ";
+            _append_list(out, total.data(), CPU_FIELDS);
+            for (uint64_t cpu = 0; cpu < m_params.cpus; cpu++)
+            {
+                out += "cpu" + std::to_string(cpu);
+                _append_list(out, &m_cpus[cpu * CPU_FIELDS], CPU_FIELDS);
+            }
+
+            out += "intr";
+            _append_sum(out, m_intr);
+            _append_list(out, m_intr.data(), m_intr.size());
+            out += "ctxt " + std::to_string(m_ctxt) + "\n";
+            out += "btime 1760000000\n";
+            out += "processes " + std::to_string(m_processes) + "\n";
+            out += "procs_running 2\n";
+            out += "procs_blocked 0\n";
+            out += "softirq";
+            _append_sum(out, m_softirq);
+            _append_list(out, m_softirq.data(), m_softirq.size());
+
+            return out;
+        }
+
+        /**
+         * @brief Replaces the file with the rendered contents atomically,
+         * so readers never see a partial file
+         * @return true - on success, false - otherwise
+         */
+        bool write(const std::string& path) const
+        {
+            std::string tmp = path + ".tmp";
+            std::string out = render();
+
+            FILE* file = std::fopen(tmp.c_str(), "w");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            bool ok = std::fwrite(out.data(), 1, out.size(), file) ==
+                      out.size();
+            ok = std::fclose(file) == 0 && ok;
+
+            return ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+        }
+
+    private:
+        params m_params;
+        std::mt19937_64 m_random;
+        std::vector<uint64_t> m_cpus;
+        std::vector<uint64_t> m_intr;
+        std::vector<uint64_t> m_softirq;
+        uint64_t m_ctxt;
+        uint64_t m_processes;
+
+        uint64_t _random(uint64_t min, uint64_t max)
+        {
+            return std::uniform_int_distribution<uint64_t>(min, max)(
+                m_random);
+        }
+
+        static void _append_list(
+            std::string& out, const uint64_t* values, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                out += " " + std::to_string(values[i]);
+            }
+            out += "\n";
+        }
+
+        static void _append_sum(
+            std::string& out, const std::vector<uint64_t>& values)
+        {
+            uint64_t sum = 0;
+            for (uint64_t value : values)
+            {
+                sum += value;
+            }
+            out += " " + std::to_string(sum);
+        }
+    };
+
+}
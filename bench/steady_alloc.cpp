@@ -0,0 +1,285 @@
+// Runs the whole pipeline against a generated stat file and fails if any
+// frame allocates once warmed up. Covers the render thread and the poll
+// thread with the history recorder, output goes to a pipe drained into a
+// fixed buffer.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "harness.h"
+#include "stat_gen.h"
+#include "configs.h"
+#include "conf.h"
+#include "history.h"
+#include "output.h"
+#include "pipeline.h"
+#include "plan.h"
+#include "rate_poll.h"
+#include "recorder.h"
+
+static constexpr uint64_t WARMUP_FRAMES = 200;
+
+static constexpr uint64_t FRAMES = 1'000;
+
+static constexpr std::chrono::milliseconds STAT_PERIOD { 2 };
+
+/**
+ * @brief Case name and config keys replacing the built-in config ones
+ */
+struct steady_case
+{
+    const char* name;
+    pcat::bench::overrides keys;
+};
+
+/**
+ * @brief Keeps stepping the stat file in a child process, so its
+ * allocations are not counted
+ */
+static pid_t _start_stat_writer(const std::string& path)
+{
+    pcat::bench::stat_gen gen({ 8, 64, 10, 1 });
+    gen.step(0.5f, 100);
+    if (!gen.write(path))
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        return pid;
+    }
+
+    for (uint64_t i = 0;; i++)
+    {
+        // Sweeps the load so rates, colors and gauge levels all change
+        float load = static_cast<float>(i % 200) / 200.0f;
+        gen.step(i % 400 < 200 ? load : 1.0f - load, 1);
+        gen.write(path);
+        std::this_thread::sleep_for(STAT_PERIOD);
+    }
+}
+
+/**
+ * @brief Runs the pipeline with the case config and measures steady-state
+ * frames
+ * @return Result, allocs_per_op of steady-state frames
+ */
+static pcat::bench::harness::result _run_case(const steady_case& c,
+    const std::string& conf_path, const std::string& stat_path,
+    pcat::recorder& recorder)
+{
+    using namespace std::chrono;
+
+    if (!pcat::bench::write_conf(conf_path, c.keys))
+    {
+        std::fprintf(stderr, "Failed to write `%s`\n", conf_path.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+
+    pcat::conf conf(conf_path);
+    if (conf.load().any())
+    {
+        std::fprintf(stderr, "%s: invalid config\n", c.name);
+        std::exit(EXIT_FAILURE);
+    }
+
+    pcat::history::stats history_stats;
+    pcat::plan::fmt_err err;
+    auto plan = pcat::plan::make(conf, history_stats, err);
+    if (plan == nullptr)
+    {
+        std::fprintf(stderr, "%s: %s\n", c.name, err.message.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        std::fprintf(stderr, "Failed to create a pipe\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    pcat::counters counters;
+    pcat::output output(fds[1]);
+    if (!output.open())
+    {
+        std::fprintf(stderr, "%s: %s\n", c.name, output.io_err_what());
+        std::exit(EXIT_FAILURE);
+    }
+
+    pcat::rate_poll rate_poll(plan->poll_period, stat_path,
+        plan->history_samples(false), plan->spark_length,
+        pcat::clock::steady(), &counters, nullptr, nullptr, &recorder);
+    std::thread poll_thread(
+        [](pcat::rate_poll& rate_poll) { rate_poll.run(); },
+        std::ref(rate_poll));
+
+    // Closing the read end stops the pipeline with an output error
+    std::atomic<bool> done = false;
+    std::thread reader_thread(
+        [&]()
+        {
+            static char buf[pcat::output::BUFFER_SIZE];
+            while (!done.load(std::memory_order_relaxed) &&
+                   read(fds[0], buf, sizeof(buf)) > 0)
+            {
+            }
+            close(fds[0]);
+        });
+
+    pcat::pipeline pipeline(rate_poll, output, history_stats,
+        pcat::clock::steady(), &counters, nullptr);
+    std::thread render_thread(
+        [&]() { pipeline.run(std::move(plan)); });
+
+    auto wait_frames = [&](uint64_t frames)
+    {
+        while (counters.frames.load(std::memory_order_relaxed) < frames)
+        {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    };
+
+    wait_frames(WARMUP_FRAMES);
+    uint64_t allocs_start = pcat::bench::alloc_count();
+    uint64_t bytes_start = pcat::bench::alloc_byte_count();
+    uint64_t frames_start = counters.frames.load(std::memory_order_relaxed);
+    auto start = steady_clock::now();
+
+    wait_frames(frames_start + FRAMES);
+    uint64_t allocs_end = pcat::bench::alloc_count();
+    uint64_t bytes_end = pcat::bench::alloc_byte_count();
+    uint64_t frames_end = counters.frames.load(std::memory_order_relaxed);
+    auto end = steady_clock::now();
+
+    done.store(true, std::memory_order_relaxed);
+    render_thread.join();
+    reader_thread.join();
+    close(fds[1]);
+    rate_poll.stop();
+    poll_thread.join();
+
+    double ops = static_cast<double>(frames_end - frames_start);
+    double ns_per_frame =
+        duration<double, std::nano>(end - start).count() / ops;
+    return { std::string("steady/") + c.name, frames_end - frames_start,
+        ns_per_frame, ns_per_frame,
+        static_cast<double>(allocs_end - allocs_start) / ops,
+        static_cast<double>(bytes_end - bytes_start) / ops };
+}
+
+int main(int argc, char** argv)
+{
+    pcat::bench::harness harness(argc, argv);
+
+    const std::vector<steady_case> cases = {
+        { "static-plain",
+            {
+                { "high_rate", "255" },
+                { "low_rate", "255" },
+                { "poll_period", "5" },
+                { "smoothing_enabled", "false" },
+                { "sleeping_enabled", "false" },
+            } },
+        { "dynamic-waybar",
+            {
+                { "high_rate", "255" },
+                { "low_rate", "100" },
+                { "poll_period", "5" },
+                { "smoothing_value", "200" },
+                { "sleeping_enabled", "false" },
+                { "format_enabled", "true" },
+                { "format", "\"$frame $rcpu $color$avg$endcolor $spark\"" },
+                { "output", "\"waybar\"" },
+                { "color_markup", "\"pango\"" },
+            } },
+        { "gauge-i3bar",
+            {
+                { "poll_period", "1" },
+                { "mode", "\"gauge\"" },
+                { "gauge_hysteresis", "0" },
+                { "format_enabled", "true" },
+                { "format", "\"$frame $lcpu $max $p95\"" },
+                { "output", "\"i3bar\"" },
+            } },
+    };
+
+    char dir[] = "/tmp/polycat-bench-steady-XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        std::fprintf(stderr, "Failed to create temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string conf_path = std::string(dir) + "/polycat-config";
+    std::string stat_path = std::string(dir) + "/stat";
+    std::string history_path = std::string(dir) + "/history";
+
+    pcat::recorder recorder(history_path);
+    if (!recorder.open())
+    {
+        std::fprintf(stderr, "%s: %s\n", history_path.c_str(),
+            recorder.io_err_what());
+        return EXIT_FAILURE;
+    }
+
+    // Forked before any thread starts
+    pid_t writer = _start_stat_writer(stat_path);
+    if (writer < 0)
+    {
+        std::fprintf(stderr, "Failed to start the stat writer\n");
+        return EXIT_FAILURE;
+    }
+
+    // The pipeline stops on a write to the closed pipe
+    signal(SIGPIPE, SIG_IGN);
+
+    bool allocated = false;
+    for (const steady_case& c : cases)
+    {
+        if (!harness.enabled(std::string("steady/") + c.name))
+        {
+            continue;
+        }
+        pcat::bench::harness::result result =
+            _run_case(c, conf_path, stat_path, recorder);
+        harness.report(result);
+        allocated = allocated || result.allocs_per_op != 0.0;
+    }
+
+    kill(writer, SIGKILL);
+    waitpid(writer, nullptr, 0);
+    unlink(conf_path.c_str());
+    unlink(stat_path.c_str());
+    unlink(history_path.c_str());
+    unlink((stat_path + ".tmp").c_str());
+    rmdir(dir);
+
+    if constexpr (pcat::alloc_audit::ENABLED)
+    {
+        std::string report;
+        pcat::alloc_audit::report(report);
+        std::printf("\n%s", report.c_str());
+    }
+
+    if (allocated)
+    {
+        std::fprintf(stderr, "Steady-state frames allocated memory\n");
+        return EXIT_FAILURE;
+    }
+
+    return harness.finish();
+}
@@ -0,0 +1,199 @@
+// Training workload of `make pgo`: runs every output, mode, frame set and
+// format key through simulations on virtual time and polls generated stat
+// files, so the profile covers the render and poll paths without sleeping.
+// Deterministic, takes a few seconds on an instrumented build.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../stat_gen.h"
+#include "../configs.h"
+#include "conf.h"
+#include "cpu.h"
+#include "history.h"
+#include "load_profile.h"
+#include "pipeline.h"
+#include "plan.h"
+#include "simulation.h"
+
+static constexpr uint64_t STAT_POLLS = 5'000;
+
+// Sleeps, wakes up, ramps through every load and color stop
+static const char* PROFILE = R"(30s 3
+2m 0 100
+1m 100
+2m 100 0
+30s 10 15
+1m 50
+)";
+
+/**
+ * @brief Case name and config keys replacing the built-in config ones
+ */
+struct train_case
+{
+    const char* name;
+    pcat::bench::overrides keys;
+};
+
+static bool _write_file(const std::string& path, const char* contents)
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fputs(contents, file);
+    return std::fclose(file) == 0;
+}
+
+/**
+ * @brief Runs the profile with the case config
+ * @return true - on success, false - otherwise
+ */
+static bool _simulate(const train_case& c, const std::string& conf_path,
+    const pcat::load_profile& profile)
+{
+    pcat::conf conf(conf_path);
+    if (!pcat::bench::write_conf(conf_path, c.keys) || conf.load().any())
+    {
+        std::fprintf(stderr, "%s: invalid config\n", c.name);
+        return false;
+    }
+
+    pcat::history::stats history_stats;
+    pcat::plan::fmt_err err;
+    auto plan = pcat::plan::make(conf, history_stats, err);
+    if (plan == nullptr)
+    {
+        std::fprintf(stderr, "%s: %s\n", c.name, err.message.c_str());
+        return false;
+    }
+
+    std::string report;
+    pcat::simulation simulation(profile, report);
+    return simulation.run(std::move(plan), history_stats) ==
+           pcat::pipeline::status::STOPPED;
+}
+
+/**
+ * @brief Polls a generated stat file of a machine with the CPU count
+ * @return true - on success, false - otherwise
+ */
+static bool _poll(const std::string& stat_path, uint64_t cpus)
+{
+    pcat::bench::stat_gen gen({ cpus, 64 + cpus * 4, 10, 1 });
+    pcat::cpu cpu(stat_path);
+
+    for (uint64_t i = 0; i < STAT_POLLS; i++)
+    {
+        gen.step(static_cast<float>(i % 100) / 100.0f, 10);
+        if (!gen.write(stat_path))
+        {
+            return false;
+        }
+        if (!cpu.poll())
+        {
+            std::fprintf(stderr, "%s: %s%s\n", stat_path.c_str(),
+                cpu.io_err_what(), cpu.fmt_err_what());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    const std::vector<train_case> cases = {
+        { "default", {} },
+        { "ascii-log-ema",
+            {
+                { "frames", "\"|/-\\\\\"" },
+                { "rate_curve", "\"log\"" },
+                { "smoothing_kernel", "\"ema\"" },
+                { "format_enabled", "true" },
+                { "format", "\"cpu: [$rcpu] $frame $lcpu $$\"" },
+            } },
+        { "graphemes-waybar",
+            {
+                { "frames", "\"👩‍💻🧑‍🚀🇺🇸🇯🇵✋🏽é\"" },
+                { "rate_curve", "\"exp\"" },
+                { "smoothing_kernel", "\"spring\"" },
+                { "format_enabled", "true" },
+                { "format", "\"$frame $color$rcpu$endcolor $avg $spark\"" },
+                { "output", "\"waybar\"" },
+                { "color_markup", "\"pango\"" },
+            } },
+        { "separated-i3bar",
+            {
+                { "frames", "\"(o  ),( o ),(  o)\"" },
+                { "frames_separator", "\",\"" },
+                { "sleeping_frames", "\"z,zz\"" },
+                { "format_enabled", "true" },
+                { "format", "\"$color$frame$endcolor $max $p95 $spark\"" },
+                { "output", "\"i3bar\"" },
+            } },
+        { "gauge-polybar",
+            {
+                { "mode", "\"gauge\"" },
+                { "poll_period", "250" },
+                { "format_enabled", "true" },
+                { "format", "\"$color$frame$endcolor $lcpu $avg\"" },
+            } },
+        { "unsmoothed",
+            {
+                { "smoothing_enabled", "false" },
+                { "sleeping_enabled", "false" },
+                { "poll_period", "100" },
+            } },
+    };
+
+    char dir[] = "/tmp/polycat-pgo-train-XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        std::fprintf(stderr, "Failed to create temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string conf_path = std::string(dir) + "/polycat-config";
+    std::string profile_path = std::string(dir) + "/profile";
+    std::string stat_path = std::string(dir) + "/stat";
+
+    bool ok = _write_file(profile_path, PROFILE);
+    pcat::load_profile profile;
+    if (ok && !profile.load(profile_path))
+    {
+        std::fprintf(stderr, "%s: %s\n", profile_path.c_str(),
+            profile.err_what());
+        ok = false;
+    }
+
+    for (const train_case& c : cases)
+    {
+        ok = ok && _simulate(c, conf_path, profile);
+    }
+    for (uint64_t cpus : { 4, 64 })
+    {
+        ok = ok && _poll(stat_path, cpus);
+    }
+
+    unlink(conf_path.c_str());
+    unlink(profile_path.c_str());
+    unlink(stat_path.c_str());
+    unlink((stat_path + ".tmp").c_str());
+    rmdir(dir);
+
+    if (!ok)
+    {
+        std::fprintf(stderr, "Training failed\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+// Writes a generated stat file and keeps its counters evolving, so polycat
+// can be run against a machine of any size with `--stat-path`
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "../stat_gen.h"
+
+static const char* USAGE =
+    R"(Usage: statgen [options] <path>
+
+Options:
+    --cpus <n>        number of CPUs, default: 8
+    --intr <n>        number of interrupt counters, default: 64 + 4 * cpus
+    --softirq <n>     number of softirq counters, default: 10
+    --period <ms>     update period, default: 100
+    --load <percent>  constant load, default: 50
+    --wave <seconds>  load follows a triangle wave 0-100-0 instead
+    --seed <n>        random seed, default: 1
+    --once            writes the file once and exits
+)";
+
+// Kernel reports jiffies in USER_HZ
+static constexpr uint64_t USER_HZ = 100;
+
+static bool _arg(int& i, int argc, char** argv, const char* name,
+    uint64_t& value)
+{
+    if (std::strcmp(argv[i], name) != 0 || i + 1 >= argc)
+    {
+        return false;
+    }
+    value = std::strtoull(argv[++i], nullptr, 10);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    using namespace std::chrono;
+
+    uint64_t cpus = 8;
+    uint64_t intr = 0;
+    uint64_t softirq = 10;
+    uint64_t period = 100;
+    uint64_t load = 50;
+    uint64_t wave = 0;
+    uint64_t seed = 1;
+    bool once = false;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (_arg(i, argc, argv, "--cpus", cpus) ||
+            _arg(i, argc, argv, "--intr", intr) ||
+            _arg(i, argc, argv, "--softirq", softirq) ||
+            _arg(i, argc, argv, "--period", period) ||
+            _arg(i, argc, argv, "--load", load) ||
+            _arg(i, argc, argv, "--wave", wave) ||
+            _arg(i, argc, argv, "--seed", seed))
+        {
+            continue;
+        }
+        if (std::strcmp(argv[i], "--once") == 0)
+        {
+            once = true;
+        }
+        else if (argv[i][0] != '-' && path == nullptr)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            std::fputs(USAGE, stderr);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (path == nullptr || cpus == 0 || period == 0)
+    {
+        std::fputs(USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+
+    pcat::bench::stat_gen gen(
+        { cpus, intr != 0 ? intr : 64 + cpus * 4, softirq, seed });
+    uint64_t jiffies = std::max<uint64_t>(period * USER_HZ / 1000, 1);
+
+    auto start = steady_clock::now();
+    auto point = start;
+    while (true)
+    {
+        if (!gen.write(path))
+        {
+            std::fprintf(stderr, "Failed to write `%s`\n", path);
+            return EXIT_FAILURE;
+        }
+        if (once)
+        {
+            return EXIT_SUCCESS;
+        }
+
+        point += milliseconds(period);
+        std::this_thread::sleep_until(point);
+
+        float value = static_cast<float>(std::min<uint64_t>(load, 100)) /
+                      100.0f;
+        if (wave != 0)
+        {
+            float t = duration<float>(steady_clock::now() - start).count() /
+                      static_cast<float>(wave);
+            value = 1.0f - std::abs(2.0f * (t - std::floor(t)) - 1.0f);
+        }
+        gen.step(value, jiffies);
+    }
+}
@@ -0,0 +1,109 @@
+#include "alloc_audit.h"
+
+#include <atomic>
+
+#ifdef POLYCAT_ALLOC_AUDIT
+
+#include <cstdlib>
+#include <new>
+
+static std::array<std::atomic<uint64_t>, pcat::alloc_audit::PHASE_COUNT>
+    _allocs;
+
+static std::array<std::atomic<uint64_t>, pcat::alloc_audit::PHASE_COUNT>
+    _bytes;
+
+static thread_local pcat::alloc_audit::phase _phase =
+    pcat::alloc_audit::PHASE_OTHER;
+
+void* operator new(std::size_t size)
+{
+    _allocs[_phase].fetch_add(1, std::memory_order_relaxed);
+    _bytes[_phase].fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+#if __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace pcat
+{
+
+    alloc_audit::scope::scope(phase phase) noexcept :
+        m_prev(_phase)
+    {
+        _phase = phase;
+    }
+
+    alloc_audit::scope::~scope() noexcept { _phase = m_prev; }
+
+    uint64_t alloc_audit::allocs(phase phase) noexcept
+    {
+        return _allocs[phase].load(std::memory_order_relaxed);
+    }
+
+    uint64_t alloc_audit::bytes(phase phase) noexcept
+    {
+        return _bytes[phase].load(std::memory_order_relaxed);
+    }
+
+}
+
+#else
+
+namespace pcat
+{
+
+    uint64_t alloc_audit::allocs(phase) noexcept { return 0; }
+
+    uint64_t alloc_audit::bytes(phase) noexcept { return 0; }
+
+}
+
+#endif
+
+namespace pcat
+{
+
+    const std::array<const char*, alloc_audit::PHASE_COUNT>
+        alloc_audit::PHASE_NAMES = { "other", "poll", "frame" };
+
+    uint64_t alloc_audit::total_allocs() noexcept
+    {
+        uint64_t total = 0;
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            total += allocs(static_cast<phase>(i));
+        }
+        return total;
+    }
+
+    void alloc_audit::report(std::string& out)
+    {
+        out += "allocations:";
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            phase p = static_cast<phase>(i);
+            out += std::string(" ") + PHASE_NAMES[i] + " " +
+                   std::to_string(allocs(p)) + " (" +
+                   std::to_string(bytes(p)) + "B)";
+        }
+        out += "\n";
+    }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <cstdint>
+
+namespace pcat
+{
+
+    /**
+     * @brief Counts heap allocations per phase by replacing global operator
+     * new, compiled in only with POLYCAT_ALLOC_AUDIT defined
+     */
+    class alloc_audit
+    {
+    public:
+#ifdef POLYCAT_ALLOC_AUDIT
+        static constexpr bool ENABLED = true;
+#else
+        static constexpr bool ENABLED = false;
+#endif
+
+        /**
+         * @brief Part of the program allocations are attributed to
+         */
+        enum phase : uint8_t
+        {
+            PHASE_OTHER,
+            PHASE_POLL,
+            PHASE_FRAME,
+            PHASE_COUNT,
+        };
+
+        static const std::array<const char*, PHASE_COUNT> PHASE_NAMES;
+
+        /**
+         * @brief Attributes allocations of the calling thread to the phase
+         * until destroyed
+         */
+        class scope
+        {
+        public:
+#ifdef POLYCAT_ALLOC_AUDIT
+            scope(phase phase) noexcept;
+
+            ~scope() noexcept;
+
+        private:
+            phase m_prev;
+#else
+            scope(phase) noexcept {}
+#endif
+        };
+
+        /**
+         * @brief Tells the number of allocations made in the phase
+         */
+        static uint64_t allocs(phase phase) noexcept;
+
+        /**
+         * @brief Tells the number of bytes allocated in the phase
+         */
+        static uint64_t bytes(phase phase) noexcept;
+
+        /**
+         * @brief Tells the number of allocations made in every phase
+         */
+        static uint64_t total_allocs() noexcept;
+
+        /**
+         * @brief Renders allocation counts of every phase
+         * @param out Destination
+         */
+        static void report(std::string& out);
+    };
+
+}
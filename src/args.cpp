@@ -1,9 +1,9 @@
 #include "args.h"
 
-#include <filesystem>
 #include <cstdlib>
 #include <cstring>
-#include <format>
+
+#include <unistd.h>
 
 static const char* _adv_args(int& argc, char**& argv)
 {
@@ -25,20 +25,18 @@ namespace pcat
 
     static std::string _get_conf_path() noexcept
     {
-        namespace fs = std::filesystem;
-
         char* home_path_c_str = std::getenv("HOME");
 
         if (home_path_c_str == NULL)
         {
-            return args::CONF_NAME;
+            return "";
         }
 
         std::string home_path = home_path_c_str;
 
         if (home_path.empty())
         {
-            return args::CONF_NAME;
+            return "";
         }
         if (home_path.back() != '/')
         {
@@ -47,37 +45,35 @@ namespace pcat
 
         std::string conf_path = home_path + ".config/" + args::CONF_NAME;
 
-        if (fs::exists(conf_path))
+        if (access(conf_path.c_str(), F_OK) == 0)
         {
             return conf_path;
         }
         else
         {
-            return POLYCAT_PREFIX "/share/polycat/" + args::CONF_NAME;
+            return "";
         }
     }
 
-    args::parse_err::parse_err(const std::string& message) noexcept :
-        m_message(message)
-    {
-    }
-
-    const char* args::parse_err::what() const noexcept
-    {
-        return m_message.c_str();
-    }
-
     args::args(int argc, char** argv) noexcept :
         m_argc(argc),
         m_argv(argv),
         m_stat_path(STAT_PATH_DEFAULT),
         m_conf_path(_get_conf_path()),
         m_help(false),
-        m_version(false)
+        m_version(false),
+        m_stats(false),
+        m_trace_path(),
+        m_simulate_path(),
+        m_metrics_socket_path(),
+        m_metrics_file_path(),
+        m_history(false),
+        m_since(),
+        m_parse_err_what()
     {
     }
 
-    void args::parse()
+    bool args::parse() noexcept
     {
         _adv_args(m_argc, m_argv);
 
@@ -92,13 +88,77 @@ namespace pcat
             {
                 m_version = true;
             }
+            else if (_streq("--stats", arg))
+            {
+                m_stats = true;
+            }
+            else if (_streq("--trace", arg))
+            {
+                const char* value = _adv_args(m_argc, m_argv);
+                if (value == nullptr)
+                {
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
+                }
+                m_trace_path = value;
+            }
+            else if (_streq("--simulate", arg))
+            {
+                const char* value = _adv_args(m_argc, m_argv);
+                if (value == nullptr)
+                {
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
+                }
+                m_simulate_path = value;
+            }
+            else if (_streq("--metrics-socket", arg))
+            {
+                const char* value = _adv_args(m_argc, m_argv);
+                if (value == nullptr)
+                {
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
+                }
+                m_metrics_socket_path = value;
+            }
+            else if (_streq("--metrics-file", arg))
+            {
+                const char* value = _adv_args(m_argc, m_argv);
+                if (value == nullptr)
+                {
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
+                }
+                m_metrics_file_path = value;
+            }
+            else if (_streq("--history", arg))
+            {
+                m_history = true;
+            }
+            else if (_streq("--since", arg))
+            {
+                const char* value = _adv_args(m_argc, m_argv);
+                if (value == nullptr)
+                {
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
+                }
+                m_since = value;
+            }
             else if (_streq("-s", arg) || _streq("--stat-path", arg))
             {
                 const char* value = _adv_args(m_argc, m_argv);
                 if (value == nullptr)
                 {
-                    throw parse_err(std::format(
-                        "Parameter `{}` expected a value, but got none", arg));
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
                 }
                 m_stat_path = value;
             }
@@ -107,24 +167,68 @@ namespace pcat
                 const char* value = _adv_args(m_argc, m_argv);
                 if (value == nullptr)
                 {
-                    throw parse_err(std::format(
-                        "Parameter `{}` expected a value, but got none", arg));
+                    m_parse_err_what = std::string("Parameter `") + arg +
+                                       "` expected a value, but got none";
+                    return false;
                 }
                 m_conf_path = value;
             }
             else
             {
-                throw parse_err(std::format("Invalid parameter `{}`", arg));
+                m_parse_err_what =
+                    std::string("Invalid parameter `") + arg + "`";
+                return false;
             }
         }
+
+        if (!m_since.empty() && !m_history)
+        {
+            m_parse_err_what = "Parameter `--since` requires `--history`";
+            return false;
+        }
+
+        return true;
+    }
+
+    const char* args::parse_err_what() const noexcept
+    {
+        return m_parse_err_what.c_str();
     }
 
     std::string args::stat_path() const noexcept { return m_stat_path; }
 
     std::string args::conf_path() const noexcept { return m_conf_path; }
 
+    std::string args::conf_name() const noexcept
+    {
+        return m_conf_path.empty() ? EMBEDDED_CONF_NAME : m_conf_path;
+    }
+
     bool args::help() const noexcept { return m_help; };
 
     bool args::version() const noexcept { return m_version; };
 
+    bool args::stats() const noexcept { return m_stats; };
+
+    std::string args::trace_path() const noexcept { return m_trace_path; }
+
+    std::string args::simulate_path() const noexcept
+    {
+        return m_simulate_path;
+    }
+
+    std::string args::metrics_socket_path() const noexcept
+    {
+        return m_metrics_socket_path;
+    }
+
+    std::string args::metrics_file_path() const noexcept
+    {
+        return m_metrics_file_path;
+    }
+
+    bool args::history() const noexcept { return m_history; }
+
+    std::string args::since() const noexcept { return m_since; }
+
 }
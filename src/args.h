@@ -1,7 +1,6 @@
 #pragma once
 
 #include <string>
-#include <exception>
 
 namespace pcat
 {
@@ -17,7 +16,7 @@ namespace pcat
         static inline const std::string STAT_PATH_DEFAULT = "/proc/stat";
 
         static inline const std::string HELP_TEXT =
-            R"(Usage: polycat [--help] [--version] --stat-path <path> --config-path <path>
+            R"(Usage: polycat [--help] [--version] [--stats] [--trace <path>] [--simulate <path>] [--metrics-socket <path>] [--metrics-file <path>] [--history [--since <time>]] --stat-path <path> --config-path <path>
 
 Optional arguments:
     -h, --help                shows help message and exits
@@ -25,22 +24,25 @@ Optional arguments:
     -s, --stat-path <path>    sets the path for stat file used to poll the CPU
         default: "/proc/stat"
     -c, --config-path <path>  sets the path for configuration file
-        default: `$HOME/.config/polycat-config` if exists, `)" POLYCAT_PREFIX
-            R"(/share/polycat/polycat-config` otherwise)";
-
-        /**
-         * Thrown on parsing errors
-         */
-        class parse_err : public std::exception
-        {
-        public:
-            parse_err(const std::string& message) noexcept;
-
-            const char* what() const noexcept;
-
-        private:
-            std::string m_message;
-        };
+        default: `$HOME/.config/polycat-config` if exists, built-in config
+        otherwise
+    --stats                   counts frames, wakeups and polls, prints the
+        counters on SIGUSR2 and at exit
+    --trace <path>            records poll and render phases into a Chrome
+        trace JSON file
+    --simulate <path>         runs the config against a load profile on
+        virtual time and prints frame statistics per profile segment
+    --metrics-socket <path>   serves CPU load and counters in the
+        Prometheus text format on a Unix socket
+    --metrics-file <path>     writes CPU load and counters in the
+        Prometheus text format for the node_exporter textfile collector
+    --history                 prints the CPU load recorded by running
+        instances into `$XDG_RUNTIME_DIR/polycat-history` and exits
+    --since <time>            limits `--history` to samples since a time of
+        day (`14:02`) or a time ago (`90s`, `30m`, `2h`, `1d`))";
+
+        static inline const std::string EMBEDDED_CONF_NAME =
+            "<built-in config>";
 
         /**
          * @brief Constructs an instance of parser
@@ -51,9 +53,15 @@ Optional arguments:
 
         /**
          * @brief Parses given arguments and sets corresponding values
-         * @exception pcat::args::parse_err
+         * @return true - on success, false - otherwise
+         */
+        bool parse() noexcept;
+
+        /**
+         * @brief Tells parsing error message, if happened
+         * @return message string, if error happened, empty string - otherwise
          */
-        void parse();
+        const char* parse_err_what() const noexcept;
 
         /**
          * @brief Tells stat file location
@@ -63,10 +71,17 @@ Optional arguments:
 
         /**
          * @brief Tells config file location
-         * @return Config file path
+         * @return Config file path, empty string if the built-in config is
+         * used
          */
         std::string conf_path() const noexcept;
 
+        /**
+         * @brief Tells config name for messages
+         * @return Config file path or pcat::args::EMBEDDED_CONF_NAME
+         */
+        std::string conf_name() const noexcept;
+
         /**
          * @brief Tells if help was requested
          * @return true - if help was requested, false - otherwise
@@ -79,6 +94,49 @@ Optional arguments:
          */
         bool version() const noexcept;
 
+        /**
+         * @brief Tells if runtime counters were requested
+         * @return true - if counters were requested, false - otherwise
+         */
+        bool stats() const noexcept;
+
+        /**
+         * @brief Tells trace file location
+         * @return Trace file path, empty string if tracing was not requested
+         */
+        std::string trace_path() const noexcept;
+
+        /**
+         * @brief Tells load profile location
+         * @return Load profile path, empty string if simulation was not
+         * requested
+         */
+        std::string simulate_path() const noexcept;
+
+        /**
+         * @brief Tells metrics socket location
+         * @return Socket path, empty string if not requested
+         */
+        std::string metrics_socket_path() const noexcept;
+
+        /**
+         * @brief Tells metrics textfile location
+         * @return Textfile path, empty string if not requested
+         */
+        std::string metrics_file_path() const noexcept;
+
+        /**
+         * @brief Tells if recorded history was requested
+         * @return true - if history was requested, false - otherwise
+         */
+        bool history() const noexcept;
+
+        /**
+         * @brief Tells the start of requested history
+         * @return Time as given, empty string if not limited
+         */
+        std::string since() const noexcept;
+
     private:
         int m_argc;
         char** m_argv;
@@ -86,6 +144,14 @@ Optional arguments:
         std::string m_conf_path;
         bool m_help;
         bool m_version;
+        bool m_stats;
+        std::string m_trace_path;
+        std::string m_simulate_path;
+        std::string m_metrics_socket_path;
+        std::string m_metrics_file_path;
+        bool m_history;
+        std::string m_since;
+        std::string m_parse_err_what;
     };
 
 }
@@ -0,0 +1,148 @@
+#include "backend.h"
+
+#include "formatter.h"
+
+static void _append_uint(std::string& out, uint8_t value) noexcept
+{
+    char digits[3];
+    size_t length = 0;
+
+    do
+    {
+        digits[sizeof(digits) - 1 - length] = '0' + value % 10;
+        value /= 10;
+        length++;
+    } while (value != 0);
+
+    out.append(digits + sizeof(digits) - length, length);
+}
+
+static void _append_json(std::string& out, std::string_view s) noexcept
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    for (char ch : s)
+    {
+        unsigned char uch = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(ch);
+        }
+        else if (uch < 0x20)
+        {
+            out.append("\\u00");
+            out.push_back(HEX[uch >> 4]);
+            out.push_back(HEX[uch & 0xF]);
+        }
+        else
+        {
+            out.push_back(ch);
+        }
+    }
+}
+
+namespace pcat
+{
+
+    const std::string backend::PLAIN = "plain";
+
+    const std::string backend::WAYBAR = "waybar";
+
+    const std::string backend::I3BAR = "i3bar";
+
+    const std::string backend::SLEEPING_CLASS = "sleeping";
+
+    const std::string backend::RUNNING_CLASS = "running";
+
+    backend::backend(const std::string& name) noexcept :
+        m_header(),
+        m_literals(),
+        m_ops(),
+        m_deps(formatter::DEP_NONE)
+    {
+        if (name == WAYBAR)
+        {
+            add_literal("{\"text\":\"");
+            add_field(field::JSON_TEXT);
+            add_literal("\",\"percentage\":");
+            add_field(field::PERCENTAGE);
+            add_literal(",\"class\":\"");
+            add_field(field::CLASS);
+            add_literal("\",\"tooltip\":\"");
+            add_field(field::JSON_TOOLTIP);
+            add_literal("\"}");
+        }
+        else if (name == I3BAR)
+        {
+            // The status line array is never closed, an empty first element
+            // lets every line start with a comma
+            m_header = "{\"version\":1}\n[\n[]";
+            add_literal(",[{\"name\":\"polycat\",\"full_text\":\"");
+            add_field(field::JSON_TEXT);
+            add_literal("\"}]");
+        }
+        else
+        {
+            add_field(field::TEXT);
+        }
+    }
+
+    bool backend::exists(const std::string& name) noexcept
+    {
+        return name == PLAIN || name == WAYBAR || name == I3BAR;
+    }
+
+    const std::string& backend::header() const noexcept { return m_header; }
+
+    void backend::serialize(std::string& out, const args& args) const noexcept
+    {
+        for (const op& o : m_ops)
+        {
+            switch (o.f)
+            {
+            case field::LITERAL:
+                out.append(m_literals, o.offset, o.length);
+                break;
+            case field::TEXT:
+                out.append(args.text);
+                break;
+            case field::JSON_TEXT:
+                _append_json(out, args.text);
+                break;
+            case field::PERCENTAGE:
+                _append_uint(out, args.load);
+                break;
+            case field::CLASS:
+                out.append(args.sleeping ? SLEEPING_CLASS : RUNNING_CLASS);
+                break;
+            case field::JSON_TOOLTIP:
+                out.append("CPU load: ");
+                _append_uint(out, args.load);
+                out.push_back('%');
+                break;
+            }
+        }
+    }
+
+    uint8_t backend::deps() const noexcept { return m_deps; }
+
+    void backend::add_literal(const std::string& s)
+    {
+        m_ops.push_back({ field::LITERAL,
+            static_cast<uint32_t>(m_literals.length()),
+            static_cast<uint32_t>(s.length()) });
+        m_literals += s;
+    }
+
+    void backend::add_field(field f)
+    {
+        m_ops.push_back({ f, 0, 0 });
+
+        if (f == field::PERCENTAGE || f == field::JSON_TOOLTIP)
+        {
+            m_deps |= formatter::DEP_LOAD;
+        }
+    }
+
+}
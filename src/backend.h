@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <vector>
+
+namespace pcat
+{
+
+    /**
+     * @brief Serializes output lines for the bar protocol in use
+     */
+    class backend
+    {
+    public:
+        static const std::string PLAIN;
+
+        static const std::string WAYBAR;
+
+        static const std::string I3BAR;
+
+        static const std::string SLEEPING_CLASS;
+
+        static const std::string RUNNING_CLASS;
+
+        /**
+         * @brief Values available to the template
+         */
+        struct args
+        {
+            std::string_view text;
+            uint8_t load;
+            bool sleeping;
+        };
+
+        /**
+         * @brief Constructs an instance with compiled template
+         * @param name Backend name, plain backend is used for unknown names
+         */
+        backend(const std::string& name) noexcept;
+
+        /**
+         * @brief Tells if the backend exists
+         * @param name Backend name
+         * @return true - if it does, false - otherwise
+         */
+        static bool exists(const std::string& name) noexcept;
+
+        /**
+         * @brief Tells the line preceding all other output
+         * @return Header line, empty string if the protocol has no header
+         */
+        const std::string& header() const noexcept;
+
+        /**
+         * @brief Serializes the line and appends the result
+         * @param out Output buffer
+         * @param args Line values
+         */
+        void serialize(std::string& out, const args& args) const noexcept;
+
+        /**
+         * @brief Tells values the serialized line depends on
+         * @return Combination of pcat::formatter::dep flags
+         */
+        uint8_t deps() const noexcept;
+
+    private:
+        enum class field : uint8_t
+        {
+            LITERAL,
+            TEXT,
+            JSON_TEXT,
+            PERCENTAGE,
+            CLASS,
+            JSON_TOOLTIP,
+        };
+
+        struct op
+        {
+            field f;
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        std::string m_header;
+        std::string m_literals;
+        std::vector<op> m_ops;
+        uint8_t m_deps;
+
+        /**
+         * @brief Appends literal operation to the template
+         */
+        void add_literal(const std::string& s);
+
+        /**
+         * @brief Appends field operation to the template
+         */
+        void add_field(field f);
+    };
+
+}
@@ -0,0 +1,98 @@
+#include "clock.h"
+
+#include <thread>
+
+namespace pcat
+{
+
+    /**
+     * @brief Clock backed by std::chrono::steady_clock
+     */
+    class _steady_clock final : public clock
+    {
+    public:
+        time_point now() noexcept override
+        {
+            return std::chrono::steady_clock::now();
+        }
+
+        void sleep_until(time_point point) noexcept override
+        {
+            std::this_thread::sleep_until(point);
+        }
+
+        bool wait(std::unique_lock<std::mutex>& lock,
+            std::condition_variable& cv) noexcept override
+        {
+            cv.wait(lock);
+            return true;
+        }
+    };
+
+    clock& clock::steady() noexcept
+    {
+        static _steady_clock instance;
+        return instance;
+    }
+
+    virtual_clock::virtual_clock(time_point start) noexcept :
+        m_now(start),
+        m_next(time_point::max()),
+        m_task(),
+        m_observer()
+    {
+    }
+
+    void virtual_clock::schedule(time_point point, task task)
+    {
+        m_next = point;
+        m_task = std::move(task);
+    }
+
+    void virtual_clock::observe(observer observer)
+    {
+        m_observer = std::move(observer);
+    }
+
+    clock::time_point virtual_clock::now() noexcept { return m_now; }
+
+    void virtual_clock::sleep_until(time_point point) noexcept
+    {
+        if (m_observer)
+        {
+            m_observer(m_now);
+        }
+
+        while (m_next <= point)
+        {
+            run_task();
+        }
+        m_now = point > m_now ? point : m_now;
+    }
+
+    bool virtual_clock::wait(std::unique_lock<std::mutex>& lock,
+        std::condition_variable&) noexcept
+    {
+        if (m_observer)
+        {
+            m_observer(m_now);
+        }
+
+        if (m_next == time_point::max())
+        {
+            return false;
+        }
+
+        lock.unlock();
+        run_task();
+        lock.lock();
+        return true;
+    }
+
+    void virtual_clock::run_task() noexcept
+    {
+        m_now = m_next > m_now ? m_next : m_now;
+        m_next = m_task(m_now);
+    }
+
+}
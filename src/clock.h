@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+namespace pcat
+{
+
+    /**
+     * @brief Source of time for the poll and render loops, lets them run on
+     * virtual time
+     */
+    class clock
+    {
+    public:
+        using time_point = std::chrono::steady_clock::time_point;
+
+        virtual ~clock() = default;
+
+        /**
+         * @brief Tells the current time
+         */
+        virtual time_point now() noexcept = 0;
+
+        /**
+         * @brief Blocks until specified time
+         * @param point Time to wake up at
+         */
+        virtual void sleep_until(time_point point) noexcept = 0;
+
+        /**
+         * @brief Blocks on the condition variable until notified, callers
+         * recheck their condition as wakeups may be spurious
+         * @param lock Lock of the mutex guarding the condition
+         * @param cv Condition variable
+         * @return true - if the condition may have changed, false - if it
+         * never will
+         */
+        virtual bool wait(std::unique_lock<std::mutex>& lock,
+            std::condition_variable& cv) noexcept = 0;
+
+        /**
+         * @brief Tells the clock backed by std::chrono::steady_clock
+         */
+        static clock& steady() noexcept;
+    };
+
+    /**
+     * @brief Clock that jumps to the next deadline instantly, everything
+     * that runs on it must run on a single thread
+     *
+     * Work that happens in the background on the steady clock, such as CPU
+     * polling, is scheduled as a task and run whenever time passes its
+     * deadline.
+     */
+    class virtual_clock : public clock
+    {
+    public:
+        /**
+         * @brief Runs at the scheduled time
+         * @return Time to run at next, time_point::max() to stop running
+         */
+        using task = std::function<time_point(time_point now)>;
+
+        /**
+         * @brief Called with the current time before blocking
+         */
+        using observer = std::function<void(time_point now)>;
+
+        /**
+         * @brief Constructs an instance
+         * @param start Initial time
+         */
+        virtual_clock(time_point start) noexcept;
+
+        /**
+         * @brief Sets the task, replacing the previous one
+         * @param point Time to run the task at first
+         * @param task Task
+         */
+        void schedule(time_point point, task task);
+
+        /**
+         * @brief Sets the observer called on every sleep and wait, the render
+         * loop blocks after every frame
+         * @param observer Observer
+         */
+        void observe(observer observer);
+
+        time_point now() noexcept override;
+
+        /**
+         * @brief Advances the time, running the task at every deadline
+         * passed on the way
+         */
+        void sleep_until(time_point point) noexcept override;
+
+        /**
+         * @brief Advances the time to the next run of the task and runs it
+         * with the lock released
+         * @return false - if no task is scheduled, true - otherwise
+         */
+        bool wait(std::unique_lock<std::mutex>& lock,
+            std::condition_variable& cv) noexcept override;
+
+    private:
+        time_point m_now;
+        time_point m_next;
+        task m_task;
+        observer m_observer;
+
+        /**
+         * @brief Advances the time to the task deadline and runs it
+         */
+        void run_task() noexcept;
+    };
+
+}
@@ -1,10 +1,19 @@
 #include "conf.h"
 
 #include <limits>
+#include <variant>
+
+#include "backend.h"
+#include "gradient.h"
+#include "smoother.h"
 
 namespace pcat
 {
 
+    const std::string conf::MODE_ANIMATION = "animation";
+
+    const std::string conf::MODE_GAUGE = "gauge";
+
     conf::fmt_err::fmt_err(const std::string& message) noexcept :
         m_message(message)
     {
@@ -32,7 +41,14 @@ namespace pcat
 
         parse p;
 
-        errs.parse_errs = p.load(m_path);
+        if (m_path.empty())
+        {
+            errs.parse_errs = p.load_embedded();
+        }
+        else
+        {
+            errs.parse_errs = p.load(m_path);
+        }
 
         if (errs.any())
         {
@@ -40,11 +56,14 @@ namespace pcat
         }
 
         std::string frames = "";
+        std::string frames_separator = "";
         uint64_t low_rate = 0;
         uint64_t high_rate = 0;
+        std::string rate_curve = "linear";
         uint64_t poll_period = 0;
         bool smoothing_enabled = false;
         uint64_t smoothing_value = 0;
+        std::string smoothing_kernel = smoother::LINEAR_KERNEL;
         bool sleeping_enabled = false;
         uint64_t sleeping_threshold = 0;
         uint64_t wakeup_threshold = 0;
@@ -52,13 +71,23 @@ namespace pcat
         uint64_t sleeping_rate = 0;
         bool format_enabled = false;
         std::string format = "";
+        std::string output = backend::PLAIN;
+        std::string mode = MODE_ANIMATION;
+        uint64_t gauge_hysteresis = 2;
+        std::string color_stops = "#00ff00 #ffff00 #ff0000";
+        std::string color_markup = gradient::POLYBAR_MARKUP;
+        uint64_t history_window = 60;
+        uint64_t spark_length = 8;
 
         bool frames_loaded = false;
+        [[maybe_unused]] bool frames_separator_loaded = false;
         bool low_rate_loaded = false;
         bool high_rate_loaded = false;
+        [[maybe_unused]] bool rate_curve_loaded = false;
         bool poll_period_loaded = false;
         [[maybe_unused]] bool smoothing_enabled_loaded = false;
         bool smoothing_value_loaded = false;
+        bool smoothing_kernel_loaded = false;
         [[maybe_unused]] bool sleeping_enabled_loaded = false;
         bool sleeping_threshold_loaded = false;
         bool wakeup_threshold_loaded = false;
@@ -66,28 +95,46 @@ namespace pcat
         bool sleeping_rate_loaded = false;
         [[maybe_unused]] bool format_enabled_loaded = false;
         [[maybe_unused]] bool format_loaded = false;
+        bool output_loaded = false;
+        bool mode_loaded = false;
+        bool gauge_hysteresis_loaded = false;
+        [[maybe_unused]] bool color_stops_loaded = false;
+        bool color_markup_loaded = false;
+        bool history_window_loaded = false;
+        bool spark_length_loaded = false;
+
+        parse::get_err get_err;
 
 #define _GET_VALUE(name, type) \
-    try \
+    if (auto value = p.get_##type(#name, get_err)) \
     { \
-        name = p.get_##type(#name); \
+        name = *value; \
         name##_loaded = true; \
     } \
-    catch (const parse::no_key_err& e) \
+    else if (auto e = std::get_if<parse::no_key_err>(&get_err)) \
     { \
-        errs.no_key_errs.push_back(e); \
+        errs.no_key_errs.push_back(*e); \
     } \
-    catch (const parse::type_err& e) \
+    else if (auto e = std::get_if<parse::type_err>(&get_err)) \
     { \
-        errs.type_errs.push_back(e); \
+        errs.type_errs.push_back(*e); \
+    }
+
+#define _GET_OPTIONAL_VALUE(name, type) \
+    if (p.has_key(#name)) \
+    { \
+        _GET_VALUE(name, type); \
     }
 
         _GET_VALUE(frames, string);
+        _GET_OPTIONAL_VALUE(frames_separator, string);
         _GET_VALUE(low_rate, int);
         _GET_VALUE(high_rate, int);
+        _GET_OPTIONAL_VALUE(rate_curve, string);
         _GET_VALUE(poll_period, int);
         _GET_VALUE(smoothing_enabled, bool);
         _GET_VALUE(smoothing_value, int);
+        _GET_OPTIONAL_VALUE(smoothing_kernel, string);
         _GET_VALUE(sleeping_enabled, bool);
         _GET_VALUE(sleeping_threshold, int);
         _GET_VALUE(wakeup_threshold, int);
@@ -95,7 +142,15 @@ namespace pcat
         _GET_VALUE(sleeping_rate, int);
         _GET_VALUE(format_enabled, bool);
         _GET_VALUE(format, string);
-
+        _GET_OPTIONAL_VALUE(output, string);
+        _GET_OPTIONAL_VALUE(mode, string);
+        _GET_OPTIONAL_VALUE(gauge_hysteresis, int);
+        _GET_OPTIONAL_VALUE(color_stops, string);
+        _GET_OPTIONAL_VALUE(color_markup, string);
+        _GET_OPTIONAL_VALUE(history_window, int);
+        _GET_OPTIONAL_VALUE(spark_length, int);
+
+#undef _GET_OPTIONAL_VALUE
 #undef _GET_VALUE
 
         if (frames_loaded && (frames.length() < 1))
@@ -131,6 +186,13 @@ namespace pcat
                 "`smoothing_value` should be an integer in range [1-10000]"));
         }
 
+        if (smoothing_kernel_loaded &&
+            !smoother::kernel_exists(smoothing_kernel))
+        {
+            errs.fmt_errs.push_back(fmt_err("`smoothing_kernel` should be one "
+                                            "of `linear`, `ema`, `spring`"));
+        }
+
         if (sleeping_threshold_loaded &&
             (sleeping_threshold < 1 || sleeping_threshold > 100))
         {
@@ -167,12 +229,60 @@ namespace pcat
                 "`sleeping_rate` should be an integer in range [1-255]"));
         }
 
+        if (output_loaded && !backend::exists(output))
+        {
+            errs.fmt_errs.push_back(fmt_err(
+                "`output` should be one of `plain`, `waybar`, `i3bar`"));
+        }
+
+        if (mode_loaded && mode != MODE_ANIMATION && mode != MODE_GAUGE)
+        {
+            errs.fmt_errs.push_back(
+                fmt_err("`mode` should be one of `animation`, `gauge`"));
+        }
+
+        if (gauge_hysteresis_loaded && gauge_hysteresis > 100)
+        {
+            errs.fmt_errs.push_back(fmt_err(
+                "`gauge_hysteresis` should be an integer in range [0-100]"));
+        }
+
+        if (color_markup_loaded && !gradient::markup_exists(color_markup))
+        {
+            errs.fmt_errs.push_back(
+                fmt_err("`color_markup` should be one of `polybar`, `pango`"));
+        }
+
+        if (history_window_loaded &&
+            (history_window < 1 || history_window > 86'400))
+        {
+            errs.fmt_errs.push_back(fmt_err(
+                "`history_window` should be an integer in range [1-86400]"));
+        }
+        else if (poll_period >= 1 &&
+                 history_window * 1000 / poll_period > HISTORY_SAMPLES_MAX)
+        {
+            errs.fmt_errs.push_back(
+                fmt_err("`history_window` should hold at most " +
+                        std::to_string(HISTORY_SAMPLES_MAX) +
+                        " polls of `poll_period`"));
+        }
+
+        if (spark_length_loaded && (spark_length < 1 || spark_length > 64))
+        {
+            errs.fmt_errs.push_back(
+                fmt_err("`spark_length` should be an integer in range [1-64]"));
+        }
+
         m_frames = frames;
+        m_frames_separator = frames_separator;
         m_low_rate = low_rate;
         m_high_rate = high_rate;
+        m_rate_curve = rate_curve;
         m_poll_period = poll_period;
         m_smoothing_enabled = smoothing_enabled;
         m_smoothing_value = smoothing_value;
+        m_smoothing_kernel = smoothing_kernel;
         m_sleeping_enabled = sleeping_enabled;
         m_sleeping_threshold = sleeping_threshold;
         m_wakeup_threshold = wakeup_threshold;
@@ -180,16 +290,33 @@ namespace pcat
         m_sleeping_rate = sleeping_rate;
         m_format_enabled = format_enabled;
         m_format = format;
+        m_output = output;
+        m_mode = mode;
+        m_gauge_hysteresis = gauge_hysteresis;
+        m_color_stops = color_stops;
+        m_color_markup = color_markup;
+        m_history_window = history_window;
+        m_spark_length = spark_length;
 
         return errs;
     }
 
-    std::string conf::frames() const noexcept { return m_frames; }
+    const std::string& conf::frames() const noexcept { return m_frames; }
+
+    const std::string& conf::frames_separator() const noexcept
+    {
+        return m_frames_separator;
+    }
 
     uint8_t conf::high_rate() const noexcept { return m_high_rate; }
 
     uint8_t conf::low_rate() const noexcept { return m_low_rate; }
 
+    const std::string& conf::rate_curve() const noexcept
+    {
+        return m_rate_curve;
+    }
+
     uint64_t conf::poll_period() const noexcept { return m_poll_period; }
 
     bool conf::smoothing_enabled() const noexcept
@@ -202,6 +329,11 @@ namespace pcat
         return m_smoothing_value;
     }
 
+    const std::string& conf::smoothing_kernel() const noexcept
+    {
+        return m_smoothing_kernel;
+    }
+
     bool conf::sleeping_enabled() const noexcept { return m_sleeping_enabled; }
 
     uint8_t conf::sleeping_threshold() const noexcept
@@ -214,7 +346,7 @@ namespace pcat
         return m_wakeup_threshold;
     }
 
-    std::string conf::sleeping_frames() const noexcept
+    const std::string& conf::sleeping_frames() const noexcept
     {
         return m_sleeping_frames;
     }
@@ -223,5 +355,28 @@ namespace pcat
 
     bool conf::format_enabled() const noexcept { return m_format_enabled; }
 
-    std::string conf::format() const noexcept { return m_format; }
+    const std::string& conf::format() const noexcept { return m_format; }
+
+    const std::string& conf::output() const noexcept { return m_output; }
+
+    const std::string& conf::mode() const noexcept { return m_mode; }
+
+    uint8_t conf::gauge_hysteresis() const noexcept
+    {
+        return m_gauge_hysteresis;
+    }
+
+    const std::string& conf::color_stops() const noexcept
+    {
+        return m_color_stops;
+    }
+
+    const std::string& conf::color_markup() const noexcept
+    {
+        return m_color_markup;
+    }
+
+    uint64_t conf::history_window() const noexcept { return m_history_window; }
+
+    uint8_t conf::spark_length() const noexcept { return m_spark_length; }
 }
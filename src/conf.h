@@ -2,7 +2,6 @@
 
 #include <string>
 #include <cstdint>
-#include <exception>
 #include <vector>
 
 #include "parse.h"
@@ -16,10 +15,20 @@ namespace pcat
     class conf
     {
     public:
+        static const std::string MODE_ANIMATION;
+
+        static const std::string MODE_GAUGE;
+
+        /**
+         * @brief Most polls a history window can hold, every one is kept in
+         * memory
+         */
+        static constexpr uint64_t HISTORY_SAMPLES_MAX = 100'000;
+
         /**
-         * @brief Thrown on type errors
+         * @brief Describes an invalid config value
          */
-        class fmt_err : public std::exception
+        class fmt_err
         {
         public:
             fmt_err(const std::string& message) noexcept;
@@ -50,7 +59,8 @@ namespace pcat
 
         /**
          * @brief Constructs an instance with associated config path
-         * @param config_path Path to config file
+         * @param config_path Path to config file, empty string to use the
+         * config embedded at build time
          */
         conf(const std::string& config_path) noexcept;
 
@@ -63,7 +73,12 @@ namespace pcat
         /**
          * @brief Returns the FRAMES_KEY value from config
          */
-        std::string frames() const noexcept;
+        const std::string& frames() const noexcept;
+
+        /**
+         * @brief Returns the FRAMES_SEPARATOR_KEY value from config
+         */
+        const std::string& frames_separator() const noexcept;
 
         /**
          * @brief Returns the HIGH_RATE_KEY value from config
@@ -75,6 +90,11 @@ namespace pcat
          */
         uint8_t low_rate() const noexcept;
 
+        /**
+         * @brief Returns the RATE_CURVE_KEY value from config
+         */
+        const std::string& rate_curve() const noexcept;
+
         /**
          * @brief Returns the POLL_PERIOD_KEY value from config
          */
@@ -90,6 +110,11 @@ namespace pcat
          */
         uint64_t smoothing_value() const noexcept;
 
+        /**
+         * @brief Returns the SMOOTHING_KERNEL_KEY value from config
+         */
+        const std::string& smoothing_kernel() const noexcept;
+
         /**
          * @brief Returns the SLEEPING_ENABLED_KEY value from config
          */
@@ -108,7 +133,7 @@ namespace pcat
         /**
          * @brief Returns the SLEEPING_FRAMES_KEY value from config
          */
-        std::string sleeping_frames() const noexcept;
+        const std::string& sleeping_frames() const noexcept;
 
         /**
          * @brief Returns the SLEEPING_RATE_KEY value from config
@@ -123,17 +148,55 @@ namespace pcat
         /**
          * @brief Returns the FORMAT_KEY value from config
          */
-        std::string format() const noexcept;
+        const std::string& format() const noexcept;
+
+        /**
+         * @brief Returns the OUTPUT_KEY value from config
+         */
+        const std::string& output() const noexcept;
+
+        /**
+         * @brief Returns the MODE_KEY value from config
+         */
+        const std::string& mode() const noexcept;
+
+        /**
+         * @brief Returns the GAUGE_HYSTERESIS_KEY value from config
+         */
+        uint8_t gauge_hysteresis() const noexcept;
+
+        /**
+         * @brief Returns the COLOR_STOPS_KEY value from config
+         */
+        const std::string& color_stops() const noexcept;
+
+        /**
+         * @brief Returns the COLOR_MARKUP_KEY value from config
+         */
+        const std::string& color_markup() const noexcept;
+
+        /**
+         * @brief Returns the HISTORY_WINDOW_KEY value from config
+         */
+        uint64_t history_window() const noexcept;
+
+        /**
+         * @brief Returns the SPARK_LENGTH_KEY value from config
+         */
+        uint8_t spark_length() const noexcept;
 
     private:
         std::string m_path;
 
         std::string m_frames;
+        std::string m_frames_separator;
         uint8_t m_low_rate;
         uint8_t m_high_rate;
+        std::string m_rate_curve;
         uint64_t m_poll_period;
         bool m_smoothing_enabled;
         uint64_t m_smoothing_value;
+        std::string m_smoothing_kernel;
         bool m_sleeping_enabled;
         uint8_t m_sleeping_threshold;
         uint8_t m_wakeup_threshold;
@@ -141,6 +204,13 @@ namespace pcat
         uint8_t m_sleeping_rate;
         bool m_format_enabled;
         std::string m_format;
+        std::string m_output;
+        std::string m_mode;
+        uint8_t m_gauge_hysteresis;
+        std::string m_color_stops;
+        std::string m_color_markup;
+        uint64_t m_history_window;
+        uint8_t m_spark_length;
     };
 
 }
@@ -0,0 +1,165 @@
+#include "conf_watch.h"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static constexpr uint32_t DIR_EVENTS =
+    IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+static constexpr uint32_t FILE_EVENTS =
+    IN_CLOSE_WRITE | IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF;
+
+namespace pcat
+{
+
+    conf_watch::conf_watch(const std::string& path) noexcept :
+        m_path(path),
+        m_dir("."),
+        m_name(path),
+        m_fd(-1),
+        m_stop_fd(-1),
+        m_dir_wd(-1),
+        m_file_wd(-1),
+        m_errno(0)
+    {
+        size_t pos = path.rfind('/');
+        if (pos != std::string::npos)
+        {
+            m_dir = pos == 0 ? "/" : path.substr(0, pos);
+            m_name = path.substr(pos + 1);
+        }
+    }
+
+    conf_watch::~conf_watch() noexcept
+    {
+        if (m_fd != -1)
+        {
+            close(m_fd);
+        }
+        if (m_stop_fd != -1)
+        {
+            close(m_stop_fd);
+        }
+    }
+
+    bool conf_watch::open() noexcept
+    {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (m_fd == -1 || m_stop_fd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        m_dir_wd = inotify_add_watch(m_fd, m_dir.c_str(), DIR_EVENTS);
+        if (m_dir_wd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+        watch_file();
+
+        return true;
+    }
+
+    bool conf_watch::wait() noexcept
+    {
+        pollfd fds[2] = {
+            { m_fd, POLLIN, 0 },
+            { m_stop_fd, POLLIN, 0 },
+        };
+
+        bool changed = false;
+        while (true)
+        {
+            // Block until the first change, then until events settle
+            int n = poll(fds, 2, changed ? SETTLE_MS : -1);
+            if (n == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                m_errno = errno;
+                return false;
+            }
+
+            if (fds[1].revents != 0 || m_errno != 0)
+            {
+                return false;
+            }
+
+            if (n == 0)
+            {
+                watch_file();
+                return true;
+            }
+
+            changed = read_events() || changed;
+        }
+    }
+
+    void conf_watch::stop() noexcept
+    {
+        uint64_t value = 1;
+        [[maybe_unused]] ssize_t n = write(m_stop_fd, &value, sizeof(value));
+    }
+
+    bool conf_watch::io_err() const noexcept { return m_errno != 0; }
+
+    const char* conf_watch::io_err_what() const noexcept
+    {
+        return m_errno != 0 ? std::strerror(m_errno) : "";
+    }
+
+    bool conf_watch::read_events() noexcept
+    {
+        alignas(inotify_event) char buf[4096];
+        bool changed = false;
+
+        while (true)
+        {
+            ssize_t n = read(m_fd, buf, sizeof(buf));
+            if (n == -1)
+            {
+                if (errno != EAGAIN && errno != EINTR)
+                {
+                    m_errno = errno;
+                }
+                return changed;
+            }
+
+            for (ssize_t off = 0; off < n;)
+            {
+                const inotify_event* event =
+                    reinterpret_cast<const inotify_event*>(buf + off);
+                off += sizeof(inotify_event) + event->len;
+
+                if (event->wd == m_file_wd && event->wd != m_dir_wd)
+                {
+                    changed = true;
+                }
+                else if (event->wd == m_dir_wd && event->len != 0 &&
+                         m_name == event->name)
+                {
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    void conf_watch::watch_file() noexcept
+    {
+        // May fail while the file is being replaced, the directory watch
+        // reports it once it is back
+        m_file_wd = inotify_add_watch(m_fd, m_path.c_str(), FILE_EVENTS);
+    }
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+
+namespace pcat
+{
+
+    /**
+     * @brief Watches the config file for changes with inotify, the directory
+     * is watched too as editors often replace the file instead of writing it
+     */
+    class conf_watch
+    {
+    public:
+        /**
+         * @brief Time the watch waits for more events after a change, so
+         * multi-step saves are seen as a single change
+         */
+        static constexpr int SETTLE_MS = 50;
+
+        /**
+         * @brief Constructs an instance for specified config file
+         * @param path Path to config file
+         */
+        conf_watch(const std::string& path) noexcept;
+
+        ~conf_watch() noexcept;
+
+        conf_watch(const conf_watch&) = delete;
+
+        conf_watch& operator=(const conf_watch&) = delete;
+
+        /**
+         * @brief Creates the inotify instance and the watches
+         * @return true - on success, false - otherwise
+         */
+        bool open() noexcept;
+
+        /**
+         * @brief Blocks until the config file changes
+         * @return true - if the file changed, false - if stopped or on error
+         */
+        bool wait() noexcept;
+
+        /**
+         * @brief Makes wait() return false, can be called from any thread
+         */
+        void stop() noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
+
+    private:
+        std::string m_path;
+        std::string m_dir;
+        std::string m_name;
+        int m_fd;
+        int m_stop_fd;
+        int m_dir_wd;
+        int m_file_wd;
+        int m_errno;
+
+        /**
+         * @brief Reads pending events
+         * @return true - if any of them concerns the config file
+         */
+        bool read_events() noexcept;
+
+        /**
+         * @brief Watches the file itself, its inode changes when replaced
+         */
+        void watch_file() noexcept;
+    };
+
+}
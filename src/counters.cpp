@@ -0,0 +1,129 @@
+#include "counters.h"
+
+#include <sys/resource.h>
+
+static uint64_t _get(const std::atomic<uint64_t>& counter) noexcept
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+namespace pcat
+{
+
+    counters::counters() noexcept :
+        start(std::chrono::steady_clock::now()),
+        frames(0),
+        dropped(0),
+        suppressed(0),
+        wakeups(0),
+        polls(0),
+        poll_ns(0),
+        poll_max_ns(0),
+        stat_bytes(0),
+        stat_syscalls(0),
+        writes(0),
+        sleeps(0),
+        waits(0),
+        lateness(),
+        lateness_ns(0),
+        load_displayed(0.0f),
+        sleeping(false)
+    {
+        for (std::atomic<uint64_t>& bucket : lateness)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void counters::add_lateness(std::chrono::nanoseconds late) noexcept
+    {
+        uint64_t us = late.count() > 0 ? late.count() / 1000 : 0;
+
+        size_t bucket = 0;
+        while (bucket < LATENESS_BOUNDS.size() && us >= LATENESS_BOUNDS[bucket])
+        {
+            bucket++;
+        }
+        lateness[bucket].fetch_add(1, std::memory_order_relaxed);
+        lateness_ns.fetch_add(
+            late.count() > 0 ? late.count() : 0, std::memory_order_relaxed);
+    }
+
+    void counters::add_poll(std::chrono::nanoseconds duration,
+        uint64_t bytes, uint64_t syscalls) noexcept
+    {
+        uint64_t ns = duration.count() > 0 ? duration.count() : 0;
+
+        polls.fetch_add(1, std::memory_order_relaxed);
+        poll_ns.fetch_add(ns, std::memory_order_relaxed);
+        stat_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        stat_syscalls.fetch_add(syscalls, std::memory_order_relaxed);
+
+        // Only the poll thread writes the maximum
+        if (ns > _get(poll_max_ns))
+        {
+            poll_max_ns.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void counters::report(std::string& out) const
+    {
+        using namespace std::chrono;
+
+        uint64_t uptime_ms =
+            duration_cast<milliseconds>(steady_clock::now() - start).count();
+        uint64_t poll_count = _get(polls);
+        uint64_t poll_avg_us =
+            poll_count != 0 ? _get(poll_ns) / poll_count / 1000 : 0;
+
+        using std::to_string;
+
+        out += "polycat stats: uptime " + to_string(uptime_ms) + "ms\n";
+        out += "frames: emitted " + to_string(_get(frames)) + " dropped " +
+               to_string(_get(dropped)) + " suppressed " +
+               to_string(_get(suppressed)) + "\n";
+        out += "wakeups: render " + to_string(_get(wakeups)) + " poll " +
+               to_string(poll_count) + "\n";
+        out += "polls: " + to_string(poll_count) + " avg " +
+               to_string(poll_avg_us) + "us max " +
+               to_string(_get(poll_max_ns) / 1000) + "us stat bytes " +
+               to_string(_get(stat_bytes)) + "\n";
+        out += "syscalls: stat " + to_string(_get(stat_syscalls)) +
+               " write " + to_string(_get(writes)) + " sleep " +
+               to_string(_get(sleeps)) + " wait " + to_string(_get(waits)) +
+               "\n";
+
+        out += "lateness:";
+        for (size_t i = 0; i < lateness.size(); i++)
+        {
+            if (i < LATENESS_BOUNDS.size())
+            {
+                out += " <" + to_string(LATENESS_BOUNDS[i]) + "us " +
+                       to_string(_get(lateness[i]));
+            }
+            else
+            {
+                out += " more " + to_string(_get(lateness[i]));
+            }
+        }
+        out += "\n";
+
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            uint64_t utime_ms = usage.ru_utime.tv_sec * 1000 +
+                                usage.ru_utime.tv_usec / 1000;
+            uint64_t stime_ms = usage.ru_stime.tv_sec * 1000 +
+                                usage.ru_stime.tv_usec / 1000;
+            out += "process: peak rss " + to_string(usage.ru_maxrss) +
+                   "KiB user " + to_string(utime_ms) + "ms system " +
+                   to_string(stime_ms) + "ms\n";
+            out += "page faults: minor " + to_string(usage.ru_minflt) +
+                   " major " + to_string(usage.ru_majflt) + "\n";
+            out += "context switches: voluntary " +
+                   to_string(usage.ru_nvcsw) + " involuntary " +
+                   to_string(usage.ru_nivcsw) + "\n";
+        }
+    }
+
+}
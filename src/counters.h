@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace pcat
+{
+
+    /**
+     * @brief Runtime counters of the render loop and the CPU poll, updated
+     * with relaxed atomics and read by the reporting thread
+     */
+    struct counters
+    {
+        /**
+         * @brief Upper bounds of the frame lateness histogram buckets in
+         * microseconds, the last bucket is unbounded
+         */
+        static constexpr std::array<uint64_t, 7> LATENESS_BOUNDS = {
+            100,
+            500,
+            1'000,
+            2'000,
+            5'000,
+            10'000,
+            50'000,
+        };
+
+        counters() noexcept;
+
+        /**
+         * @brief Counts a frame that woke up late by specified duration
+         * @param late Actual minus planned wakeup time
+         */
+        void add_lateness(std::chrono::nanoseconds late) noexcept;
+
+        /**
+         * @brief Counts a CPU poll
+         * @param duration Time the poll took
+         * @param bytes Bytes read from the stat file
+         * @param syscalls System calls made to read the stat file
+         */
+        void add_poll(std::chrono::nanoseconds duration, uint64_t bytes,
+            uint64_t syscalls) noexcept;
+
+        /**
+         * @brief Renders a compact report, includes process resource usage
+         * and page faults
+         * @param out Destination
+         */
+        void report(std::string& out) const;
+
+        std::chrono::steady_clock::time_point start;
+
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> suppressed;
+        std::atomic<uint64_t> wakeups;
+        std::atomic<uint64_t> polls;
+        std::atomic<uint64_t> poll_ns;
+        std::atomic<uint64_t> poll_max_ns;
+        std::atomic<uint64_t> stat_bytes;
+
+        // System calls by kind, sleeps and waits on either thread
+        std::atomic<uint64_t> stat_syscalls;
+        std::atomic<uint64_t> writes;
+        std::atomic<uint64_t> sleeps;
+        std::atomic<uint64_t> waits;
+        std::array<std::atomic<uint64_t>, LATENESS_BOUNDS.size() + 1> lateness;
+        std::atomic<uint64_t> lateness_ns;
+
+        // Latest state of the render loop
+        std::atomic<float> load_displayed;
+        std::atomic<bool> sleeping;
+    };
+
+}
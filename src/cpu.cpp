@@ -1,119 +1,179 @@
 #include "cpu.h"
 
-#include <sstream>
-#include <numeric>
-#include <vector>
-#include <fstream>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <system_error>
 
-namespace pcat
-{
-
-    cpu::io_err::io_err(const std::string& message) noexcept :
-        m_message(message)
-    {
-    }
+#include <fcntl.h>
+#include <unistd.h>
 
-    const char* cpu::io_err::what() const noexcept { return m_message.c_str(); }
+static bool _is_blank(char ch) { return ch == ' ' || ch == '\t' || ch == '\r'; }
 
-    cpu::fmt_err::fmt_err(const std::string& message) noexcept :
-        m_message(message)
+static const char* _skip_blank(const char* pos, const char* end)
+{
+    while (pos != end && _is_blank(*pos))
     {
+        pos++;
     }
+    return pos;
+}
 
-    const char* cpu::fmt_err::what() const noexcept
+static const char* _skip_token(const char* pos, const char* end)
+{
+    while (pos != end && !_is_blank(*pos))
     {
-        return m_message.c_str();
+        pos++;
     }
+    return pos;
+}
+
+namespace pcat
+{
 
     cpu::cpu(const std::string& stat_path) noexcept :
         m_stat_path(stat_path),
-        m_state_prev({ 0, 0 })
+        m_state_prev({ 0, 0 }),
+        m_read_bytes(0),
+        m_syscalls(0),
+        m_io_err_what(nullptr),
+        m_fmt_err_what(nullptr)
     {
     }
 
-    float cpu::poll()
+    std::optional<float> cpu::poll() noexcept
     {
-        state state_curr = get_state();
+        m_io_err_what = nullptr;
+        m_fmt_err_what = nullptr;
 
-        uint64_t work_d = state_curr.work - m_state_prev.work;
-        uint64_t total_d = state_curr.total - m_state_prev.total;
+        std::optional<state> state_curr = get_state();
+        if (!state_curr)
+        {
+            return std::nullopt;
+        }
+
+        uint64_t work_d = state_curr->work - m_state_prev.work;
+        uint64_t total_d = state_curr->total - m_state_prev.total;
 
-        m_state_prev = state_curr;
+        m_state_prev = *state_curr;
 
         return static_cast<float>(work_d) / static_cast<float>(total_d);
     }
 
-    cpu::state cpu::get_state()
-    {
-        std::ifstream ifstream;
+    uint64_t cpu::read_bytes() const noexcept { return m_read_bytes; }
 
-        ifstream.exceptions(std::ios::badbit | std::ios::failbit);
+    uint64_t cpu::syscalls() const noexcept { return m_syscalls; }
 
-        try
-        {
-            ifstream.open(m_stat_path);
-        }
-        catch (std::ios::failure&)
-        {
-            throw io_err("Failed to open the stat file.");
-        }
+    bool cpu::io_err() const noexcept { return m_io_err_what != nullptr; }
+
+    const char* cpu::io_err_what() const noexcept
+    {
+        return m_io_err_what != nullptr ? m_io_err_what : "";
+    }
 
-        std::string line;
+    bool cpu::fmt_err() const noexcept { return m_fmt_err_what != nullptr; }
 
-        try
+    const char* cpu::fmt_err_what() const noexcept
+    {
+        return m_fmt_err_what != nullptr ? m_fmt_err_what : "";
+    }
+
+    std::optional<cpu::state> cpu::get_state() noexcept
+    {
+        // Only the first line is needed, it fits the buffer on any machine
+        char buf[STAT_LINE_MAX];
+        size_t size = 0;
+
+        // open(2) and close(2) are counted up front, reads as they happen
+        m_syscalls = 2;
+        int fd = open(m_stat_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
         {
-            std::getline(ifstream, line);
+            m_io_err_what = "Failed to open the stat file.";
+            return std::nullopt;
         }
-        catch (std::ios::failure&)
+
+        while (size < sizeof(buf) && std::memchr(buf, '\n', size) == nullptr)
         {
-            throw io_err("Failed to read the stat file.");
+            ssize_t n = read(fd, buf + size, sizeof(buf) - size);
+            m_syscalls++;
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0)
+            {
+                close(fd);
+                m_io_err_what = "Failed to read the stat file.";
+                return std::nullopt;
+            }
+            if (n == 0)
+            {
+                break;
+            }
+            size += static_cast<size_t>(n);
         }
+        close(fd);
 
-        std::stringstream line_stream;
-        line_stream << line;
-
-        if (!line_stream.eof())
+        const char* end =
+            static_cast<const char*>(std::memchr(buf, '\n', size));
+        if (end == nullptr)
         {
-            std::string cpu_token;
-            line_stream >> cpu_token;
-
-            if (cpu_token != std::string("cpu"))
+            if (size == sizeof(buf))
             {
-                throw fmt_err("Stat has invalid format.");
+                m_fmt_err_what = "Stat has invalid format.";
+                return std::nullopt;
             }
+            end = buf + size;
         }
-        else
+        m_read_bytes = size;
+
+        const char* pos = _skip_blank(buf, end);
+        if (pos == end)
         {
-            throw fmt_err("Stat file is empty.");
+            m_fmt_err_what = "Stat file is empty.";
+            return std::nullopt;
         }
 
-        std::vector<uint64_t> jiffies;
-        jiffies.reserve(16);
-
-        while (!line_stream.eof())
+        const char* token_end = _skip_token(pos, end);
+        if (std::string_view(pos, token_end - pos) != "cpu")
         {
-            std::string num;
-            line_stream >> num;
+            m_fmt_err_what = "Stat has invalid format.";
+            return std::nullopt;
+        }
+        pos = _skip_blank(token_end, end);
+
+        state result = { 0, 0 };
+        size_t count = 0;
 
-            try
+        while (pos != end)
+        {
+            uint64_t jiffies = 0;
+            auto [ptr, ec] = std::from_chars(pos, end, jiffies);
+            if (ec != std::errc() || (ptr != end && !_is_blank(*ptr)))
             {
-                jiffies.push_back(std::stoull(num));
+                m_fmt_err_what = "Stat file has invalid data.";
+                return std::nullopt;
             }
-            catch (...)
+
+            // user, nice and system are work, the rest is not
+            result.total += jiffies;
+            if (count < 3)
             {
-                throw fmt_err("Stat file has invalid data.");
+                result.work += jiffies;
             }
+            count++;
+
+            pos = _skip_blank(ptr, end);
         }
 
-        if (jiffies.size() < 4)
+        if (count < 4)
         {
-            throw fmt_err("Not enough data in stat file.");
+            m_fmt_err_what = "Not enough data in stat file.";
+            return std::nullopt;
         }
 
-        state result = { 0, 0 };
-        result.total = std::accumulate(jiffies.begin(), jiffies.end(), 0);
-        result.work = std::accumulate(jiffies.begin(), jiffies.begin() + 3, 0);
-
         return result;
     }
 
@@ -2,7 +2,8 @@
 
 #include <string>
 #include <cstdint>
-#include <exception>
+#include <cstddef>
+#include <optional>
 
 namespace pcat
 {
@@ -14,46 +15,56 @@ namespace pcat
     {
     public:
         /**
-         * @brief Thrown on IO errors
+         * @brief Size of the buffer the first line of stat file is read into
          */
-        class io_err : public std::exception
-        {
-        public:
-            io_err(const std::string& message) noexcept;
+        static constexpr size_t STAT_LINE_MAX = 512;
 
-            const char* what() const noexcept;
+        /**
+         * @brief Constructs an instance that polls specific stat file
+         * @param stat_path Stat file path
+         */
+        cpu(const std::string& stat_path) noexcept;
 
-        private:
-            std::string m_message;
-        };
+        /**
+         * @brief Polls stat file and calculates CPU usage
+         * @return CPU usage in range [0-1], std::nullopt on IO or format
+         * errors
+         */
+        std::optional<float> poll() noexcept;
 
         /**
-         * @brief Thrown on stat file format errors
+         * @brief Tells if an IO error has happened during the last poll
+         * @return true - on error, false - otherwise
          */
-        class fmt_err : public std::exception
-        {
-        public:
-            fmt_err(const std::string& message) noexcept;
+        bool io_err() const noexcept;
 
-            const char* what() const noexcept;
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
 
-        private:
-            std::string m_message;
-        };
+        /**
+         * @brief Tells if the stat file of the last poll was malformed
+         * @return true - on error, false - otherwise
+         */
+        bool fmt_err() const noexcept;
 
         /**
-         * @brief Constructs an instance that polls specific stat file
-         * @param stat_path Stat file path
+         * @brief Tells format error message, if happened
+         * @return message string, if error happened, empty string - otherwise
          */
-        cpu(const std::string& stat_path) noexcept;
+        const char* fmt_err_what() const noexcept;
 
         /**
-         * @brief Polls stat file and calculates CPU usage
-         * @return CPU usage in range [0-1]
-         * @exception pcat::cpu::io_err
-         * @exception pcat::cpu::fmt_err
+         * @brief Tells the number of bytes read by the last poll
+         */
+        uint64_t read_bytes() const noexcept;
+
+        /**
+         * @brief Tells the number of system calls made by the last poll
          */
-        float poll();
+        uint64_t syscalls() const noexcept;
 
     private:
         /**
@@ -67,14 +78,16 @@ namespace pcat
 
         std::string m_stat_path;
         state m_state_prev;
+        uint64_t m_read_bytes;
+        uint64_t m_syscalls;
+        const char* m_io_err_what;
+        const char* m_fmt_err_what;
 
         /**
          * @brief Extracts CPU state from stat file
-         * @return CPU state structure
-         * @exception pcat::cpu::io_err
-         * @exception pcat::cpu::fmt_err
+         * @return CPU state structure, std::nullopt on errors
          */
-        state get_state();
+        std::optional<state> get_state() noexcept;
     };
 
 }
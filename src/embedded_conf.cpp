@@ -0,0 +1,23 @@
+#include "embedded_conf.h"
+
+// Generated from res/polycat-config as a raw string literal
+static constexpr std::string_view TEXT =
+#include "polycat-config.inc"
+    ;
+
+static constexpr pcat::embedded_conf::entries ENTRIES =
+    pcat::embedded_conf::split(TEXT);
+
+static_assert(ENTRIES.valid, "res/polycat-config is malformed");
+
+namespace pcat
+{
+
+    std::string_view embedded_conf::text() noexcept { return TEXT; }
+
+    const embedded_conf::entries& embedded_conf::get() noexcept
+    {
+        return ENTRIES;
+    }
+
+}
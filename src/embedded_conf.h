@@ -0,0 +1,154 @@
+#pragma once
+
+#include <string_view>
+#include <array>
+#include <cstddef>
+
+namespace pcat
+{
+
+    /**
+     * @brief Default config embedded at build time, split into key-value
+     * pairs at compile time
+     */
+    class embedded_conf
+    {
+    public:
+        static constexpr size_t MAX_ENTRIES = 64;
+
+        /**
+         * @brief Key and unparsed value
+         */
+        struct entry
+        {
+            std::string_view key;
+            std::string_view value;
+        };
+
+        /**
+         * @brief Entries of the config
+         */
+        struct entries
+        {
+            std::array<entry, MAX_ENTRIES> list;
+            size_t count;
+            bool valid;
+        };
+
+        /**
+         * @brief Splits config text into entries, same rules as
+         * pcat::parse::load(), values are checked but left unparsed
+         * @param text Config text
+         * @return Entries, valid is false on malformed lines, malformed
+         * values or duplicate keys
+         */
+        static constexpr entries split(std::string_view text) noexcept
+        {
+            entries result { {}, 0, true };
+
+            while (!text.empty())
+            {
+                size_t end = text.find('\n');
+                std::string_view line = text.substr(0, end);
+                text = end == std::string_view::npos ? std::string_view()
+                                                     : text.substr(end + 1);
+
+                line = trim(line);
+                if (line.empty())
+                {
+                    continue;
+                }
+
+                size_t pos = line.find('=');
+                if (pos == std::string_view::npos ||
+                    result.count == MAX_ENTRIES)
+                {
+                    result.valid = false;
+                    break;
+                }
+
+                entry e {
+                    trim(line.substr(0, pos)),
+                    trim(line.substr(pos + 1)),
+                };
+                if (e.key.empty() || !value(e.value) || contains(result, e.key))
+                {
+                    result.valid = false;
+                    break;
+                }
+
+                result.list[result.count++] = e;
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Tells the embedded config text
+         */
+        static std::string_view text() noexcept;
+
+        /**
+         * @brief Tells the entries of embedded config
+         */
+        static const entries& get() noexcept;
+
+    private:
+        static constexpr bool blank(char ch) noexcept
+        {
+            return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' ||
+                   ch == '\f';
+        }
+
+        static constexpr bool value(std::string_view s) noexcept
+        {
+            if (s.size() >= 2 && s.front() == '"' && s.back() == '"')
+            {
+                return true;
+            }
+            if (s == "true" || s == "false")
+            {
+                return true;
+            }
+            if (s.empty() || s.size() > 18)
+            {
+                return false;
+            }
+            for (char ch : s)
+            {
+                if (ch < '0' || ch > '9')
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static constexpr bool contains(
+            const entries& e, std::string_view key) noexcept
+        {
+            for (size_t i = 0; i < e.count; i++)
+            {
+                if (e.list[i].key == key)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static constexpr std::string_view trim(std::string_view s) noexcept
+        {
+            while (!s.empty() && blank(s.front()))
+            {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && blank(s.back()))
+            {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+    };
+
+}
@@ -1,38 +1,53 @@
 #include "formatter.h"
 
-#include <sstream>
 #include <cstddef>
+#include <cmath>
 
-size_t count_occurences(
-    const std::string& string, const std::string& substring) noexcept
+static void _append_load(std::string& out, uint8_t load, bool right) noexcept
 {
-    size_t occurences = 0;
-    std::string::size_type pos = 0;
-    while ((pos = string.find(substring, pos)) != std::string::npos)
+    char digits[4];
+    size_t length = 0;
+
+    do
     {
-        occurences += 1;
-        pos += substring.length();
-    }
+        digits[sizeof(digits) - 1 - length] = '0' + load % 10;
+        load /= 10;
+        length++;
+    } while (load != 0);
 
-    return occurences;
-}
+    // Value and `%` are padded to 4 characters
+    size_t padding = 3 - length;
 
-void replace_all(std::string& string, const std::string& substring_old,
-    const std::string& substring_new) noexcept
-{
-    if (substring_old.empty())
+    if (right)
     {
-        return;
+        out.append(padding, ' ');
     }
-
-    std::string::size_type pos = 0;
-    while ((pos = string.find(substring_old, pos)) != std::string::npos)
+    out.append(digits + sizeof(digits) - length, length);
+    out.push_back('%');
+    if (!right)
     {
-        string.replace(pos, substring_old.length(), substring_new);
-        pos += substring_new.length();
+        out.append(padding, ' ');
     }
 }
 
+static void _frame_key(std::string& out, const pcat::formatter::args& args,
+    const void*) noexcept
+{
+    out.append(args.frame);
+}
+
+static void _lcpu_key(std::string& out, const pcat::formatter::args& args,
+    const void*) noexcept
+{
+    _append_load(out, args.load, false);
+}
+
+static void _rcpu_key(std::string& out, const pcat::formatter::args& args,
+    const void*) noexcept
+{
+    _append_load(out, args.load, true);
+}
+
 namespace pcat
 {
 
@@ -44,78 +59,136 @@ namespace pcat
 
     const std::string formatter::FRAME_KEY = "frame";
 
-    const std::string formatter::PREFIX_KEY = "$";
-
-    formatter::fmt_err::fmt_err(const std::string& message) noexcept :
-        m_message(message)
-    {
-    }
-
-    const char* formatter::fmt_err::what() const noexcept
+    formatter::formatter() noexcept :
+        m_keys(),
+        m_literals(),
+        m_ops(),
+        m_deps(DEP_NONE),
+        m_fmt_err_what()
     {
-        return m_message.c_str();
+        m_keys.push_back({ FRAME_KEY, _frame_key, DEP_FRAME, nullptr });
+        m_keys.push_back({ L_CPU_LOAD_KEY, _lcpu_key, DEP_LOAD, nullptr });
+        m_keys.push_back({ R_CPU_LOAD_KEY, _rcpu_key, DEP_LOAD, nullptr });
     }
 
-    formatter::formatter() noexcept :
-        m_format(),
-        m_rcpu_fmt(),
-        m_lcpu_fmt(),
-        m_frame_fmt(),
-        m_prefix_fmt()
+    void formatter::add_key(
+        const std::string& name, key_fn fn, uint8_t deps, const void* data)
     {
+        for (key& k : m_keys)
+        {
+            if (k.name == name)
+            {
+                k = { name, fn, deps, data };
+                return;
+            }
+        }
+        m_keys.push_back({ name, fn, deps, data });
     }
 
-    void formatter::set(const std::string& format)
+    bool formatter::set(const std::string& format)
     {
-        std::string rcpu_fmt = FORMAT_PREFIX + R_CPU_LOAD_KEY;
-        std::string lcpu_fmt = FORMAT_PREFIX + L_CPU_LOAD_KEY;
-        std::string frame_fmt = FORMAT_PREFIX + FRAME_KEY;
-        std::string prefix_fmt = FORMAT_PREFIX + PREFIX_KEY;
-
-        size_t prefix_occurences = count_occurences(format, FORMAT_PREFIX);
-        size_t rcpu_occurences = count_occurences(format, rcpu_fmt);
-        size_t lcpu_occurences = count_occurences(format, lcpu_fmt);
-        size_t frame_occurences = count_occurences(format, frame_fmt);
-        size_t esc_prefix_occurences = count_occurences(format, prefix_fmt);
+        std::string literals;
+        std::vector<op> ops;
+        uint8_t deps = DEP_NONE;
 
-        prefix_occurences -= esc_prefix_occurences;
-
-        if (prefix_occurences != rcpu_occurences + lcpu_occurences +
-                                     frame_occurences + esc_prefix_occurences)
+        auto push_literal = [&](const char* begin, size_t length)
+        {
+            // Adjacent literals are merged into a single operation
+            if (!ops.empty() && ops.back().fn == nullptr)
+            {
+                ops.back().length += length;
+            }
+            else
+            {
+                ops.push_back({ nullptr, nullptr,
+                    static_cast<uint32_t>(literals.length()),
+                    static_cast<uint32_t>(length) });
+            }
+            literals.append(begin, length);
+        };
+
+        size_t pos = 0;
+        while (pos < format.length())
         {
-            std::stringstream message;
-            message << "String \"" << format << "\" has incorrect format.";
-            throw fmt_err(message.str());
+            size_t prefix_pos = format.find(FORMAT_PREFIX, pos);
+            if (prefix_pos == std::string::npos)
+            {
+                push_literal(format.data() + pos, format.length() - pos);
+                break;
+            }
+
+            push_literal(format.data() + pos, prefix_pos - pos);
+            pos = prefix_pos + FORMAT_PREFIX.length();
+
+            // Escaped prefix
+            size_t prefix_length = FORMAT_PREFIX.length();
+            if (format.compare(pos, prefix_length, FORMAT_PREFIX) == 0)
+            {
+                push_literal(FORMAT_PREFIX.data(), prefix_length);
+                pos += prefix_length;
+                continue;
+            }
+
+            // The longest key name wins, so that text may follow a key
+            const key* match = nullptr;
+            for (const key& k : m_keys)
+            {
+                bool longer = match == nullptr ||
+                              k.name.length() > match->name.length();
+                if (longer && format.compare(pos, k.name.length(), k.name) == 0)
+                {
+                    match = &k;
+                }
+            }
+
+            if (match == nullptr)
+            {
+                m_fmt_err_what =
+                    "String \"" + format + "\" has incorrect format.";
+                return false;
+            }
+
+            ops.push_back({ match->fn, match->data, 0, 0 });
+            deps |= match->deps;
+            pos += match->name.length();
         }
 
-        m_format = format;
-        m_rcpu_fmt = rcpu_fmt;
-        m_lcpu_fmt = lcpu_fmt;
-        m_frame_fmt = frame_fmt;
-        m_prefix_fmt = prefix_fmt;
+        m_literals = std::move(literals);
+        m_ops = std::move(ops);
+        m_deps = deps;
+        return true;
     }
 
-    std::string formatter::format(
-        const std::string& frame, uint8_t load) const noexcept
+    const char* formatter::fmt_err_what() const noexcept
     {
-        std::string result = m_format;
-
-        std::string r_load_string =
-            std::to_string(static_cast<uint32_t>(load)) + std::string("%");
-        std::string l_load_string = r_load_string;
+        return m_fmt_err_what.c_str();
+    }
 
-        while (l_load_string.length() < 4 && r_load_string.length() < 4)
+    void formatter::format(std::string& out, const args& args) const noexcept
+    {
+        for (const op& o : m_ops)
         {
-            r_load_string = " " + r_load_string;
-            l_load_string = l_load_string + " ";
+            if (o.fn == nullptr)
+            {
+                out.append(m_literals, o.offset, o.length);
+            }
+            else
+            {
+                o.fn(out, args, o.data);
+            }
         }
+    }
 
-        replace_all(result, m_prefix_fmt, FORMAT_PREFIX);
-        replace_all(result, m_frame_fmt, frame);
-        replace_all(result, m_rcpu_fmt, r_load_string);
-        replace_all(result, m_lcpu_fmt, l_load_string);
+    uint8_t formatter::percent(float load) noexcept
+    {
+        return static_cast<uint8_t>(std::lround(load_clamp(load) * 100.0f));
+    }
 
-        return result;
+    uint8_t formatter::deps() const noexcept { return m_deps; }
+
+    bool formatter::uses_load() const noexcept
+    {
+        return (m_deps & DEP_LOAD) != 0;
     }
 
 }
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
-#include <exception>
+#include <cstddef>
+#include <vector>
 
 namespace pcat
 {
@@ -21,51 +23,134 @@ namespace pcat
 
         static const std::string FRAME_KEY;
 
-        static const std::string PREFIX_KEY;
+        /**
+         * @brief Number of values percent() can return
+         */
+        static constexpr size_t LOAD_VALUES = 101;
 
         /**
-         * @brief Thrown on format errors
+         * @brief Values a key output may depend on
          */
-        class fmt_err : public std::exception
+        enum dep : uint8_t
         {
-        public:
-            fmt_err(const std::string& message) noexcept;
-
-            const char* what() const noexcept;
+            DEP_NONE = 0,
+            DEP_FRAME = 1 << 0,
+            DEP_LOAD = 1 << 1,
+            DEP_HISTORY = 1 << 2,
+        };
 
-        private:
-            std::string m_message;
+        /**
+         * @brief Values available to keys
+         */
+        struct args
+        {
+            std::string_view frame;
+            uint8_t load;
         };
 
         /**
-         * @brief Constructs an empty instance
+         * @brief Appends the key value to output
+         */
+        using key_fn = void (*)(
+            std::string& out, const args& args, const void* data) noexcept;
+
+        /**
+         * @brief Constructs an empty instance with default keys registered
          */
         formatter() noexcept;
 
         /**
-         * @brief Sets current format,
+         * @brief Registers a key, has to be called before format is set
+         * @param name Key name without prefix
+         * @param fn Function appending key value
+         * @param deps Values the key output depends on
+         * @param data Pointer passed to fn, has to outlive the formatter
+         */
+        void add_key(const std::string& name, key_fn fn, uint8_t deps,
+            const void* data = nullptr);
+
+        /**
+         * @brief Sets current format and compiles it,
          * Example format: "$frame $lcpu",
          * Available keys: $frame, $lcpu, $rcpu, $$
          * @param format Format string
-         * @exception pcat::formatter::fmt_err
+         * @return true - on success, false - otherwise
+         */
+        bool set(const std::string& format);
+
+        /**
+         * @brief Tells why the last set failed
+         * @return message string, if set failed, empty string - otherwise
+         */
+        const char* fmt_err_what() const noexcept;
+
+        /**
+         * @brief Formats using current format and appends the result
+         * @param out Output buffer
+         * @param args Key values
          */
-        void set(const std::string& format);
+        void format(std::string& out, const args& args) const noexcept;
 
         /**
-         * @brief Formats the string using current format
-         * @param frame Animation frame
+         * @brief Clamps CPU load into range [0-1], NaN (no jiffies elapsed)
+         * maps to 0
          * @param load CPU load
-         * @return Formatted string
+         * @return Value in range [0-1]
          */
-        std::string format(
-            const std::string& frame, uint8_t load) const noexcept;
+        static float load_clamp(float load) noexcept
+        {
+            // Comparisons with NaN are false
+            if (!(load > 0.0f))
+            {
+                return 0.0f;
+            }
+            return load < 1.0f ? load : 1.0f;
+        }
+
+        /**
+         * @brief Converts CPU load into the value displayed by keys
+         * @param load CPU load in range [0-1]
+         * @return Value in range [0-100]
+         */
+        static uint8_t percent(float load) noexcept;
+
+        /**
+         * @brief Tells values the current format depends on
+         * @return Combination of pcat::formatter::dep flags
+         */
+        uint8_t deps() const noexcept;
+
+        /**
+         * @brief Tells if current format displays CPU load
+         * @return true - if it does, false - otherwise
+         */
+        bool uses_load() const noexcept;
 
     private:
-        std::string m_format;
-        std::string m_rcpu_fmt;
-        std::string m_lcpu_fmt;
-        std::string m_frame_fmt;
-        std::string m_prefix_fmt;
+        struct key
+        {
+            std::string name;
+            key_fn fn;
+            uint8_t deps;
+            const void* data;
+        };
+
+        /**
+         * @brief Compiled format operation, appends a literal if fn is null
+         */
+        struct op
+        {
+            key_fn fn;
+            const void* data;
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        std::vector<key> m_keys;
+        std::string m_literals;
+        std::vector<op> m_ops;
+        uint8_t m_deps;
+        std::string m_fmt_err_what;
     };
 
 }
@@ -1,85 +1,201 @@
 #include "framer.h"
 
-static std::u32string _utf8_to_utf32(const std::string& utf8)
+/**
+ * @brief Decodes a code point validating the sequence
+ * @param utf8 UTF-8 string
+ * @param pos Sequence position, advanced past the sequence on success
+ * @param cp Decoded code point
+ * @return true - on success, false - on malformed sequence
+ */
+static bool _decode_utf8(const std::string& utf8, size_t& pos, char32_t& cp)
 {
-    std::u32string result;
-    size_t i = 0;
-    while (i < utf8.size())
+    unsigned char ch = utf8[pos];
+    size_t length = 0;
+    char32_t min = 0;
+
+    if (ch < 0x80)
     {
-        uint32_t cp = 0;
-        unsigned char ch = utf8[i];
-        if (ch < 0x80)
-        {
-            cp = ch;
-            i += 1;
-        }
-        else if ((ch >> 5) == 0x6)
-        {
-            cp = ((utf8[i] & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
-            i += 2;
-        }
-        else if ((ch >> 4) == 0xE)
-        {
-            cp = ((utf8[i] & 0x0F) << 12) | ((utf8[i + 1] & 0x3F) << 6) |
-                 (utf8[i + 2] & 0x3F);
-            i += 3;
-        }
-        else if ((ch >> 3) == 0x1E)
-        {
-            cp = ((utf8[i] & 0x07) << 18) | ((utf8[i + 1] & 0x3F) << 12) |
-                 ((utf8[i + 2] & 0x3F) << 6) | (utf8[i + 3] & 0x3F);
-            i += 4;
-        }
-        result += cp;
+        cp = ch;
+        pos += 1;
+        return true;
     }
-    return result;
-}
-
-static std::string _encode_utf8(char32_t cp)
-{
-    std::string result;
-
-    if (cp <= 0x7F)
+    else if ((ch >> 5) == 0x6)
     {
-        result += static_cast<char>(cp);
+        cp = ch & 0x1F;
+        length = 2;
+        min = 0x80;
     }
-    else if (cp <= 0x7FF)
+    else if ((ch >> 4) == 0xE)
     {
-        result += static_cast<char>(0xC0 | ((cp >> 6) & 0x1F));
-        result += static_cast<char>(0x80 | (cp & 0x3F));
+        cp = ch & 0x0F;
+        length = 3;
+        min = 0x800;
     }
-    else if (cp <= 0xFFFF)
+    else if ((ch >> 3) == 0x1E)
     {
-        result += static_cast<char>(0xE0 | ((cp >> 12) & 0x0F));
-        result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
-        result += static_cast<char>(0x80 | (cp & 0x3F));
+        cp = ch & 0x07;
+        length = 4;
+        min = 0x1'00'00;
     }
-    else if (cp <= 0x10'FF'FF)
+    else
     {
-        result += static_cast<char>(0xF0 | ((cp >> 18) & 0x07));
-        result += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
-        result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
-        result += static_cast<char>(0x80 | (cp & 0x3F));
+        return false;
     }
 
-    return result;
+    if (utf8.length() - pos < length)
+    {
+        return false;
+    }
+
+    for (size_t i = 1; i < length; i++)
+    {
+        unsigned char cont = utf8[pos + i];
+        if ((cont >> 6) != 0x2)
+        {
+            return false;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+
+    // Overlong encodings, surrogates and values past the Unicode range
+    if (cp < min || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10'FF'FF)
+    {
+        return false;
+    }
+
+    pos += length;
+    return true;
+}
+
+/**
+ * @brief Tells if the code point extends the preceding grapheme cluster
+ */
+static bool _is_extend(char32_t cp)
+{
+    return (cp >= 0x0300 && cp <= 0x036F) || // Combining diacritical marks
+           (cp >= 0x1AB0 && cp <= 0x1AFF) ||
+           (cp >= 0x1DC0 && cp <= 0x1DFF) ||
+           (cp >= 0x20D0 && cp <= 0x20FF) || // Marks for symbols, keycaps
+           (cp == 0x200C || cp == 0x200D) || // ZWNJ, ZWJ
+           (cp >= 0xFE00 && cp <= 0xFE0F) || // Variation selectors
+           (cp >= 0xFE20 && cp <= 0xFE2F) ||
+           (cp >= 0x1'F3'FB && cp <= 0x1'F3'FF) || // Emoji modifiers
+           (cp >= 0xE'00'20 && cp <= 0xE'00'7F) || // Tags
+           (cp >= 0xE'01'00 && cp <= 0xE'01'EF);
+}
+
+static bool _is_regional_indicator(char32_t cp)
+{
+    return cp >= 0x1'F1'E6 && cp <= 0x1'F1'FF;
 }
 
 namespace pcat
 {
 
-    framer::framer(const std::string& frames) noexcept :
+    framer::framer() noexcept :
         m_curr(0),
-        m_frames(_utf8_to_utf32(frames)),
-        m_count(m_frames.length())
+        m_buffer(),
+        m_frames(),
+        m_count(0),
+        m_fmt_err_what()
     {
     }
 
-    std::string framer::get() noexcept
+    bool framer::set(const std::string& frames, const std::string& separator)
     {
-        std::string frame = _encode_utf8(m_frames.at(m_curr));
+        std::vector<frame> result;
+
+        auto push_frame = [&](size_t begin, size_t end)
+        {
+            if (end > begin)
+            {
+                result.push_back({ static_cast<uint32_t>(begin),
+                    static_cast<uint32_t>(end - begin) });
+            }
+        };
+
+        // Validate the whole string first, so that splitting is safe
+        for (size_t pos = 0; pos < frames.length();)
+        {
+            char32_t cp = 0;
+            if (!_decode_utf8(frames, pos, cp))
+            {
+                m_fmt_err_what = "String \"" + frames +
+                                 "\" has invalid UTF-8 sequence at byte " +
+                                 std::to_string(pos) + ".";
+                return false;
+            }
+        }
+
+        if (!separator.empty())
+        {
+            size_t begin = 0;
+            size_t end = 0;
+            while ((end = frames.find(separator, begin)) != std::string::npos)
+            {
+                push_frame(begin, end);
+                begin = end + separator.length();
+            }
+            push_frame(begin, frames.length());
+        }
+        else
+        {
+            // Simplified extended grapheme clusters: combining marks,
+            // variation selectors and emoji modifiers stay with their base,
+            // ZWJ joins the following code point, regional indicators pair
+            size_t begin = 0;
+            size_t pos = 0;
+            char32_t prev = 0;
+            size_t regional = 0;
+            while (pos < frames.length())
+            {
+                size_t cp_pos = pos;
+                char32_t cp = 0;
+                _decode_utf8(frames, pos, cp);
+
+                bool joined = cp_pos != begin &&
+                              (_is_extend(cp) || prev == 0x200D ||
+                                  (_is_regional_indicator(cp) &&
+                                      regional % 2 == 1));
+                if (!joined)
+                {
+                    push_frame(begin, cp_pos);
+                    begin = cp_pos;
+                }
+
+                regional = _is_regional_indicator(cp) ? regional + 1 : 0;
+                prev = cp;
+            }
+            push_frame(begin, frames.length());
+        }
+
+        if (result.empty())
+        {
+            m_fmt_err_what = "String \"" + frames + "\" has no frames.";
+            return false;
+        }
+
+        m_curr = 0;
+        m_buffer = frames;
+        m_frames = std::move(result);
+        m_count = m_frames.size();
+        return true;
+    }
+
+    const char* framer::fmt_err_what() const noexcept
+    {
+        return m_fmt_err_what.c_str();
+    }
+
+    std::string_view framer::get() noexcept { return at(next()); }
+
+    uint64_t framer::next() noexcept
+    {
+        uint64_t curr = m_curr;
         m_curr = (m_curr + 1) % m_count;
-        return frame;
+        return curr;
     }
 
+    uint64_t framer::count() const noexcept { return m_count; }
+
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <vector>
 
 namespace pcat
 {
@@ -10,20 +12,62 @@ namespace pcat
     {
     public:
         /**
-         * @brief Construct an instance with specified frames
-         * @param frames String of frames
+         * @brief Constructs an instance without frames
          */
-        framer(const std::string& frames) noexcept;
+        framer() noexcept;
+
+        /**
+         * @brief Validates and splits frames, every grapheme cluster is a
+         * frame if separator is empty
+         * @param frames UTF-8 string of frames
+         * @param separator Frame separator
+         * @return true - on success, false - otherwise
+         */
+        bool set(const std::string& frames, const std::string& separator = "");
+
+        /**
+         * @brief Tells why the last set failed
+         * @return message string, if set failed, empty string - otherwise
+         */
+        const char* fmt_err_what() const noexcept;
 
         /**
          * @brief Tells the current frame and switches to next
          */
-        std::string get() noexcept;
+        std::string_view get() noexcept;
+
+        /**
+         * @brief Tells the current frame index and switches to next
+         */
+        uint64_t next() noexcept;
+
+        /**
+         * @brief Tells the frame at specified index
+         * @param index Frame index in range [0-count)
+         */
+        std::string_view at(uint64_t index) const noexcept
+        {
+            const frame& f = m_frames[index];
+            return std::string_view(m_buffer.data() + f.offset, f.length);
+        }
+
+        /**
+         * @brief Tells the number of frames
+         */
+        uint64_t count() const noexcept;
 
     private:
+        struct frame
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
         uint64_t m_curr;
-        std::u32string m_frames;
+        std::string m_buffer;
+        std::vector<frame> m_frames;
         uint64_t m_count;
+        std::string m_fmt_err_what;
     };
 
 }
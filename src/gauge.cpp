@@ -0,0 +1,34 @@
+#include "gauge.h"
+
+#include <algorithm>
+
+#include "formatter.h"
+
+namespace pcat
+{
+
+    gauge::gauge(uint64_t buckets, float hysteresis) noexcept :
+        m_buckets(buckets),
+        m_hysteresis(hysteresis),
+        m_curr(0)
+    {
+    }
+
+    uint64_t gauge::bucket(float load) noexcept
+    {
+        load = formatter::load_clamp(load);
+
+        float width = 1.0f / m_buckets;
+        float lower = m_curr * width - m_hysteresis;
+        float upper = (m_curr + 1) * width + m_hysteresis;
+
+        if (load < lower || load > upper)
+        {
+            uint64_t bucket = static_cast<uint64_t>(load * m_buckets);
+            m_curr = std::min(bucket, m_buckets - 1);
+        }
+
+        return m_curr;
+    }
+
+}
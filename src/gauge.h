@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pcat
+{
+
+    /**
+     * @brief Maps CPU load to one of equally sized buckets
+     */
+    class gauge
+    {
+    public:
+        /**
+         * @brief Constructs an instance with specified bucket count
+         * @param buckets Number of buckets
+         * @param hysteresis Load change past bucket bounds required to leave
+         * the current bucket, value in range [0-1]
+         */
+        gauge(uint64_t buckets, float hysteresis) noexcept;
+
+        /**
+         * @brief Tells the bucket for CPU load
+         * @param load Value in range [0-1]
+         * @return Bucket index in range [0-buckets)
+         */
+        uint64_t bucket(float load) noexcept;
+
+    private:
+        uint64_t m_buckets;
+        float m_hysteresis;
+        uint64_t m_curr;
+    };
+
+}
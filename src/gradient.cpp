@@ -0,0 +1,153 @@
+#include "gradient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "parse.h"
+
+struct _rgb
+{
+    float r;
+    float g;
+    float b;
+};
+
+static bool _parse_hex(const std::string& s, _rgb& color)
+{
+    if (s.length() != 7 || s[0] != '#')
+    {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (size_t i = 1; i < s.length(); i++)
+    {
+        char ch = s[i];
+        uint32_t digit = 0;
+        if (ch >= '0' && ch <= '9')
+        {
+            digit = ch - '0';
+        }
+        else if (ch >= 'a' && ch <= 'f')
+        {
+            digit = ch - 'a' + 10;
+        }
+        else if (ch >= 'A' && ch <= 'F')
+        {
+            digit = ch - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+
+    color = { static_cast<float>((value >> 16) & 0xFF),
+        static_cast<float>((value >> 8) & 0xFF),
+        static_cast<float>(value & 0xFF) };
+    return true;
+}
+
+static void _color_key(std::string& out, const pcat::formatter::args& args,
+    const void* data) noexcept
+{
+    out.append(static_cast<const pcat::gradient*>(data)->color(args.load));
+}
+
+static void _end_color_key(std::string& out, const pcat::formatter::args&,
+    const void* data) noexcept
+{
+    out.append(static_cast<const pcat::gradient*>(data)->end());
+}
+
+namespace pcat
+{
+
+    const std::string gradient::COLOR_KEY = "color";
+
+    const std::string gradient::END_COLOR_KEY = "endcolor";
+
+    const std::string gradient::POLYBAR_MARKUP = "polybar";
+
+    const std::string gradient::PANGO_MARKUP = "pango";
+
+    gradient::gradient() noexcept :
+        m_colors(),
+        m_end(),
+        m_fmt_err_what()
+    {
+    }
+
+    bool gradient::markup_exists(const std::string& markup) noexcept
+    {
+        return markup == POLYBAR_MARKUP || markup == PANGO_MARKUP;
+    }
+
+    bool gradient::set(const std::string& stops, const std::string& markup)
+    {
+        std::vector<_rgb> colors;
+        for (const std::string& token : parse::words(stops))
+        {
+            _rgb color;
+            if (!_parse_hex(token, color))
+            {
+                m_fmt_err_what =
+                    "Color `" + token + "` is not in `#rrggbb` format.";
+                return false;
+            }
+            colors.push_back(color);
+        }
+
+        if (colors.empty())
+        {
+            m_fmt_err_what = "String \"" + stops + "\" has no colors.";
+            return false;
+        }
+
+        bool pango = markup == PANGO_MARKUP;
+
+        for (size_t load = 0; load < formatter::LOAD_VALUES; load++)
+        {
+            // Position between the two nearest stops
+            float pos = static_cast<float>(load) /
+                        (formatter::LOAD_VALUES - 1) * (colors.size() - 1);
+            size_t i = std::min(static_cast<size_t>(pos), colors.size() - 1);
+            size_t j = std::min(i + 1, colors.size() - 1);
+            float t = pos - i;
+
+            const _rgb& a = colors[i];
+            const _rgb& b = colors[j];
+            unsigned r = std::lround(a.r + (b.r - a.r) * t);
+            unsigned g = std::lround(a.g + (b.g - a.g) * t);
+            unsigned bl = std::lround(a.b + (b.b - a.b) * t);
+
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "#%02x%02x%02x", r, g, bl);
+
+            m_colors[load] = pango ? "<span foreground=\"" : "%{F";
+            m_colors[load] += hex;
+            m_colors[load] += pango ? "\">" : "}";
+        }
+
+        m_end = pango ? "</span>" : "%{F-}";
+        return true;
+    }
+
+    const char* gradient::fmt_err_what() const noexcept
+    {
+        return m_fmt_err_what.c_str();
+    }
+
+    void gradient::add_keys(formatter& formatter) const
+    {
+        formatter.add_key(COLOR_KEY, _color_key, formatter::DEP_LOAD, this);
+        formatter.add_key(
+            END_COLOR_KEY, _end_color_key, formatter::DEP_NONE, this);
+    }
+
+    std::string_view gradient::end() const noexcept { return m_end; }
+
+}
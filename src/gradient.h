@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+#include "formatter.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Colors the output by CPU load
+     */
+    class gradient
+    {
+    public:
+        static const std::string COLOR_KEY;
+
+        static const std::string END_COLOR_KEY;
+
+        static const std::string POLYBAR_MARKUP;
+
+        static const std::string PANGO_MARKUP;
+
+        /**
+         * @brief Constructs an instance without colors
+         */
+        gradient() noexcept;
+
+        /**
+         * @brief Tells if the markup exists
+         * @param markup Markup name
+         * @return true - if it does, false - otherwise
+         */
+        static bool markup_exists(const std::string& markup) noexcept;
+
+        /**
+         * @brief Interpolates color markup for every CPU load value,
+         * Example stops: "#00ff00 #ffff00 #ff0000"
+         * @param stops Evenly spaced colors from 0% to 100% load
+         * @param markup Markup name
+         * @return true - on success, false - otherwise
+         */
+        bool set(const std::string& stops, const std::string& markup);
+
+        /**
+         * @brief Tells why the last set failed
+         * @return message string, if set failed, empty string - otherwise
+         */
+        const char* fmt_err_what() const noexcept;
+
+        /**
+         * @brief Registers $color and $endcolor keys
+         * @param formatter Formatter to register keys in
+         */
+        void add_keys(formatter& formatter) const;
+
+        /**
+         * @brief Tells the markup starting the color
+         * @param load CPU load in range [0-100]
+         */
+        std::string_view color(uint8_t load) const noexcept
+        {
+            return m_colors[load];
+        }
+
+        /**
+         * @brief Tells the markup ending the color
+         */
+        std::string_view end() const noexcept;
+
+    private:
+        std::array<std::string, formatter::LOAD_VALUES> m_colors;
+        std::string m_end;
+        std::string m_fmt_err_what;
+    };
+
+}
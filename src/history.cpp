@@ -0,0 +1,187 @@
+#include "history.h"
+
+#include <algorithm>
+
+static const char* const SPARK_BLOCKS[] = {
+    "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"
+};
+
+static constexpr size_t SPARK_BLOCK_SIZE = 3;
+
+static constexpr size_t SPARK_BLOCK_COUNT = 8;
+
+static void _append_percent(std::string& out, uint8_t value) noexcept
+{
+    char digits[3];
+    size_t length = 0;
+
+    do
+    {
+        digits[sizeof(digits) - 1 - length] = '0' + value % 10;
+        value /= 10;
+        length++;
+    } while (value != 0);
+
+    // Left-aligned like $lcpu
+    out.append(digits + sizeof(digits) - length, length);
+    out.push_back('%');
+    out.append(3 - length, ' ');
+}
+
+static const pcat::history::stats& _stats(const void* data) noexcept
+{
+    return *static_cast<const pcat::history::stats*>(data);
+}
+
+static void _avg_key(std::string& out, const pcat::formatter::args&,
+    const void* data) noexcept
+{
+    _append_percent(out, _stats(data).avg);
+}
+
+static void _max_key(std::string& out, const pcat::formatter::args&,
+    const void* data) noexcept
+{
+    _append_percent(out, _stats(data).max);
+}
+
+static void _p95_key(std::string& out, const pcat::formatter::args&,
+    const void* data) noexcept
+{
+    _append_percent(out, _stats(data).p95);
+}
+
+static void _spark_key(std::string& out, const pcat::formatter::args&,
+    const void* data) noexcept
+{
+    out.append(_stats(data).spark);
+}
+
+namespace pcat
+{
+
+    const std::string history::AVG_KEY = "avg";
+
+    const std::string history::MAX_KEY = "max";
+
+    const std::string history::P95_KEY = "p95";
+
+    const std::string history::SPARK_KEY = "spark";
+
+    history::history(uint64_t capacity, uint64_t spark_length) :
+        m_samples(capacity),
+        m_count(0),
+        m_pushed(0),
+        m_sum(0),
+        m_max(capacity),
+        m_max_head(0),
+        m_max_size(0),
+        m_histogram(),
+        m_spark_length(spark_length),
+        m_spark()
+    {
+        m_spark.reserve(spark_length * SPARK_BLOCK_SIZE);
+    }
+
+    void history::push(uint8_t load) noexcept
+    {
+        uint64_t capacity = m_samples.size();
+        if (capacity == 0)
+        {
+            return;
+        }
+        uint64_t slot = m_pushed % capacity;
+
+        if (m_count == capacity)
+        {
+            uint8_t evicted = m_samples[slot];
+            m_sum -= evicted;
+            m_histogram[evicted]--;
+        }
+        else
+        {
+            m_count++;
+        }
+
+        m_samples[slot] = load;
+        m_sum += load;
+        m_histogram[load]++;
+
+        // Candidates that left the window are at the front
+        if (m_max_size > 0 && m_max[m_max_head].index + capacity <= m_pushed)
+        {
+            m_max_head = (m_max_head + 1) % capacity;
+            m_max_size--;
+        }
+
+        // Candidates not greater than the new sample can never be maximum
+        while (m_max_size > 0 &&
+               m_max[(m_max_head + m_max_size - 1) % capacity].load <= load)
+        {
+            m_max_size--;
+        }
+
+        m_max[(m_max_head + m_max_size) % capacity] = { m_pushed, load };
+        m_max_size++;
+        m_pushed++;
+
+        render_spark();
+    }
+
+    void history::get(stats& stats) const noexcept
+    {
+        if (m_count == 0)
+        {
+            stats.avg = 0;
+            stats.max = 0;
+            stats.p95 = 0;
+            stats.spark.clear();
+            return;
+        }
+
+        stats.avg = static_cast<uint8_t>((m_sum + m_count / 2) / m_count);
+        stats.max = m_max[m_max_head].load;
+
+        // Nearest-rank percentile
+        uint64_t rank = (m_count * 95 + 99) / 100;
+        uint64_t seen = 0;
+        uint8_t p95 = 0;
+        for (size_t load = 0; load < formatter::LOAD_VALUES; load++)
+        {
+            seen += m_histogram[load];
+            if (seen >= rank)
+            {
+                p95 = static_cast<uint8_t>(load);
+                break;
+            }
+        }
+        stats.p95 = p95;
+
+        stats.spark.assign(m_spark);
+    }
+
+    void history::add_keys(formatter& formatter, const stats& stats)
+    {
+        formatter.add_key(AVG_KEY, _avg_key, formatter::DEP_HISTORY, &stats);
+        formatter.add_key(MAX_KEY, _max_key, formatter::DEP_HISTORY, &stats);
+        formatter.add_key(P95_KEY, _p95_key, formatter::DEP_HISTORY, &stats);
+        formatter.add_key(
+            SPARK_KEY, _spark_key, formatter::DEP_HISTORY, &stats);
+    }
+
+    void history::render_spark() noexcept
+    {
+        uint64_t capacity = m_samples.size();
+        uint64_t length = std::min(m_spark_length, m_count);
+
+        m_spark.clear();
+        for (uint64_t i = m_pushed - length; i < m_pushed; i++)
+        {
+            uint8_t load = m_samples[i % capacity];
+            size_t block =
+                load * SPARK_BLOCK_COUNT / formatter::LOAD_VALUES;
+            m_spark.append(SPARK_BLOCKS[block], SPARK_BLOCK_SIZE);
+        }
+    }
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <array>
+
+#include "formatter.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Keeps recent CPU load samples and their statistics
+     */
+    class history
+    {
+    public:
+        static const std::string AVG_KEY;
+
+        static const std::string MAX_KEY;
+
+        static const std::string P95_KEY;
+
+        static const std::string SPARK_KEY;
+
+        /**
+         * @brief Statistics over the window
+         */
+        struct stats
+        {
+            uint8_t avg;
+            uint8_t max;
+            uint8_t p95;
+            std::string spark;
+        };
+
+        /**
+         * @brief Constructs an empty instance
+         * @param capacity Number of samples in the window
+         * @param spark_length Number of samples shown by the sparkline
+         */
+        history(uint64_t capacity, uint64_t spark_length);
+
+        /**
+         * @brief Adds a sample evicting the oldest one if the window is full
+         * @param load CPU load in range [0-100]
+         */
+        void push(uint8_t load) noexcept;
+
+        /**
+         * @brief Copies current statistics
+         * @param stats Destination, spark capacity is reused
+         */
+        void get(stats& stats) const noexcept;
+
+        /**
+         * @brief Registers $avg, $max, $p95 and $spark keys
+         * @param formatter Formatter to register keys in
+         * @param stats Statistics read by keys
+         */
+        static void add_keys(formatter& formatter, const stats& stats);
+
+    private:
+        /**
+         * @brief Window maximum candidate
+         */
+        struct candidate
+        {
+            uint64_t index;
+            uint8_t load;
+        };
+
+        std::vector<uint8_t> m_samples;
+        uint64_t m_count;
+        uint64_t m_pushed;
+        uint64_t m_sum;
+
+        // Monotonic deque of decreasing loads, stored as a ring
+        std::vector<candidate> m_max;
+        uint64_t m_max_head;
+        uint64_t m_max_size;
+
+        std::array<uint64_t, formatter::LOAD_VALUES> m_histogram;
+
+        uint64_t m_spark_length;
+        std::string m_spark;
+
+        /**
+         * @brief Renders the sparkline of the latest samples
+         */
+        void render_spark() noexcept;
+    };
+
+}
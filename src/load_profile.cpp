@@ -0,0 +1,252 @@
+#include "load_profile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include "parse.h"
+
+static bool _parse_number(std::string_view s, int64_t& value)
+{
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.length(), value);
+    return ec == std::errc() && ptr == s.data() + s.length();
+}
+
+static bool _parse_duration(
+    const std::string& s, std::chrono::milliseconds& duration)
+{
+    using namespace std::chrono;
+
+    static constexpr std::pair<std::string_view, int64_t> UNITS[] = {
+        { "ms", 1 },
+        { "s", 1'000 },
+        { "m", 60'000 },
+        { "h", 3'600'000 },
+    };
+
+    for (const auto& [suffix, scale] : UNITS)
+    {
+        if (s.size() <= suffix.size() || !s.ends_with(suffix))
+        {
+            continue;
+        }
+
+        int64_t value = 0;
+        std::string_view number(s.data(), s.size() - suffix.size());
+        if (_parse_number(number, value) && value > 0 &&
+            value <= INT64_MAX / scale)
+        {
+            duration = milliseconds(value * scale);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _parse_load(const std::string& s, float& load)
+{
+    int64_t value = 0;
+    if (!_parse_number(s, value) || value < 0 || value > 100)
+    {
+        return false;
+    }
+
+    load = static_cast<float>(value) / 100.0f;
+    return true;
+}
+
+namespace pcat
+{
+
+    load_profile::load_profile() noexcept :
+        m_segments(),
+        m_starts(),
+        m_length(0),
+        m_io_err(false),
+        m_err_what()
+    {
+    }
+
+    bool load_profile::load(const std::string& path) noexcept
+    {
+        m_io_err = false;
+        m_err_what.clear();
+
+        std::string text;
+        parse::read_err failed;
+        if (!parse::read_file(path, text, failed))
+        {
+            m_io_err = true;
+            m_err_what = failed == parse::read_err::OPEN
+                             ? "Failed to open the profile file."
+                             : "Failed to read the profile file.";
+            return false;
+        }
+
+        std::vector<segment> segments;
+        std::chrono::milliseconds length(0);
+        size_t begin = 0;
+        for (size_t line_num = 1; begin < text.length(); line_num++)
+        {
+            size_t end = text.find('\n', begin);
+            if (end == std::string::npos)
+            {
+                end = text.length();
+            }
+            std::vector<std::string> words = parse::words(
+                std::string_view(text).substr(begin, end - begin));
+            begin = end + 1;
+
+            if (words.empty() || words[0].starts_with('#'))
+            {
+                continue;
+            }
+
+            if (words.size() < 2 || words.size() > 3)
+            {
+                m_err_what = "Line " + std::to_string(line_num) +
+                             ": expected `<duration> <load> [<load>]`";
+                return false;
+            }
+
+            segment seg { std::chrono::milliseconds(0), 0.0f, 0.0f };
+            if (!_parse_duration(words[0], seg.duration))
+            {
+                m_err_what = "Line " + std::to_string(line_num) +
+                             ": duration should be a positive integer "
+                             "followed by `ms`, `s`, `m` or `h`";
+                return false;
+            }
+            if (!_parse_load(words[1], seg.from) ||
+                !_parse_load(words.back(), seg.to))
+            {
+                m_err_what = "Line " + std::to_string(line_num) +
+                             ": load should be an integer in range [0-100]";
+                return false;
+            }
+            if (seg.duration > LENGTH_MAX - length)
+            {
+                m_err_what = "Line " + std::to_string(line_num) +
+                             ": profile should be at most " +
+                             std::to_string(LENGTH_MAX.count()) + "h long";
+                return false;
+            }
+            length += seg.duration;
+
+            segments.push_back(seg);
+        }
+
+        if (segments.empty())
+        {
+            m_err_what = "Profile has no segments";
+            return false;
+        }
+
+        m_segments = std::move(segments);
+        m_starts.clear();
+        m_length = std::chrono::milliseconds(0);
+        for (const segment& seg : m_segments)
+        {
+            m_starts.push_back(m_length);
+            m_length += seg.duration;
+        }
+        return true;
+    }
+
+    bool load_profile::io_err() const noexcept
+    {
+        return m_io_err;
+    }
+
+    bool load_profile::fmt_err() const noexcept
+    {
+        return !m_io_err && !m_err_what.empty();
+    }
+
+    const char* load_profile::err_what() const noexcept
+    {
+        return m_err_what.c_str();
+    }
+
+    const std::vector<load_profile::segment>& load_profile::segments()
+        const noexcept
+    {
+        return m_segments;
+    }
+
+    std::chrono::milliseconds load_profile::length() const noexcept
+    {
+        return m_length;
+    }
+
+    size_t load_profile::index(std::chrono::nanoseconds time) const noexcept
+    {
+        if (time >= m_length)
+        {
+            return m_segments.size();
+        }
+
+        auto it = std::upper_bound(m_starts.begin(), m_starts.end(), time);
+        return it == m_starts.begin()
+                 ? 0
+                 : static_cast<size_t>(it - m_starts.begin()) - 1;
+    }
+
+    float load_profile::load(std::chrono::nanoseconds time) const noexcept
+    {
+        using namespace std::chrono;
+
+        size_t i = index(time);
+        if (i == m_segments.size())
+        {
+            return m_segments.empty() ? 0.0f : m_segments.back().to;
+        }
+
+        const segment& seg = m_segments[i];
+        float pos = duration<float>(time - m_starts[i]) /
+                    duration<float>(seg.duration);
+        return seg.from + (seg.to - seg.from) * pos;
+    }
+
+    float load_profile::average(std::chrono::nanoseconds from,
+        std::chrono::nanoseconds to) const noexcept
+    {
+        using namespace std::chrono;
+
+        if (to <= from)
+        {
+            return load(to);
+        }
+
+        // The load is linear within segments, so the area of every piece is
+        // its length times the mean of the loads at its ends
+        float area = 0.0f;
+        nanoseconds begin = from;
+        while (begin < to)
+        {
+            size_t i = index(begin);
+            nanoseconds end = to;
+            float end_load = 0.0f;
+            if (i < m_segments.size() &&
+                m_starts[i] + m_segments[i].duration <= to)
+            {
+                // The next segment may start at a different load
+                end = m_starts[i] + m_segments[i].duration;
+                end_load = m_segments[i].to;
+            }
+            else
+            {
+                end_load = load(end);
+            }
+
+            area += (load(begin) + end_load) / 2.0f *
+                    duration<float>(end - begin).count();
+            begin = end;
+        }
+
+        return area / duration<float>(to - from).count();
+    }
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+namespace pcat
+{
+
+    /**
+     * @brief Scripted CPU load over time, a sequence of segments holding or
+     * ramping the load
+     *
+     * Every non-empty line of a profile file is a segment:
+     * `<duration> <load> [<load>]`, duration is an integer followed by `ms`,
+     * `s`, `m` or `h`, loads are percents, two loads ramp from the first to
+     * the second. Lines starting with `#` are comments.
+     */
+    class load_profile
+    {
+    public:
+        /**
+         * @brief Longest profile, simulated time is kept in nanoseconds
+         */
+        static constexpr std::chrono::hours LENGTH_MAX =
+            std::chrono::hours(24 * 365);
+
+        /**
+         * @brief Part of the profile
+         */
+        struct segment
+        {
+            std::chrono::milliseconds duration;
+            float from;
+            float to;
+        };
+
+        /**
+         * @brief Constructs an empty profile
+         */
+        load_profile() noexcept;
+
+        /**
+         * @brief Reads the profile from a file
+         * @param path Profile file path
+         * @return true - on success, false - otherwise
+         */
+        bool load(const std::string& path) noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened during the last load
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells if the last loaded file was malformed
+         * @return true - on error, false - otherwise
+         */
+        bool fmt_err() const noexcept;
+
+        /**
+         * @brief Tells why the last load failed
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* err_what() const noexcept;
+
+        /**
+         * @brief Tells the segments
+         */
+        const std::vector<segment>& segments() const noexcept;
+
+        /**
+         * @brief Tells the total duration
+         */
+        std::chrono::milliseconds length() const noexcept;
+
+        /**
+         * @brief Tells the segment containing the time
+         * @param time Time since the start of the profile
+         * @return Segment index, number of segments past the end
+         */
+        size_t index(std::chrono::nanoseconds time) const noexcept;
+
+        /**
+         * @brief Tells the load at the time, the last load past the end
+         * @param time Time since the start of the profile
+         * @return Value in range [0-1]
+         */
+        float load(std::chrono::nanoseconds time) const noexcept;
+
+        /**
+         * @brief Tells the mean load over the time range, as a stat file
+         * polled at both ends would
+         * @param from Start of the range since the start of the profile
+         * @param to End of the range since the start of the profile
+         * @return Value in range [0-1]
+         */
+        float average(std::chrono::nanoseconds from,
+            std::chrono::nanoseconds to) const noexcept;
+
+    private:
+        std::vector<segment> m_segments;
+        std::vector<std::chrono::milliseconds> m_starts;
+        std::chrono::milliseconds m_length;
+        bool m_io_err;
+        std::string m_err_what;
+    };
+
+}
@@ -0,0 +1,401 @@
+#include "metrics.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void _append_number(std::string& out, float value) noexcept
+{
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+static void _append_number(std::string& out, double value) noexcept
+{
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+static void _append_number(std::string& out, uint64_t value) noexcept
+{
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+/**
+ * @brief Appends HELP and TYPE lines
+ */
+static void _append_header(std::string& out, std::string_view name,
+    std::string_view type, std::string_view help) noexcept
+{
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+/**
+ * @brief Appends a metric without labels
+ */
+template<typename T>
+static void _append_metric(std::string& out, std::string_view name,
+    std::string_view type, std::string_view help, T value) noexcept
+{
+    _append_header(out, name, type, help);
+    out.append(name).append(" ");
+    _append_number(out, value);
+    out.append("\n");
+}
+
+/**
+ * @brief Tells whether the path holds a socket nobody listens on, as left
+ * by a killed instance
+ */
+static bool _stale_socket(const sockaddr_un& addr) noexcept
+{
+    struct stat st;
+    if (lstat(addr.sun_path, &st) == -1 || !S_ISSOCK(st.st_mode))
+    {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return false;
+    }
+    bool refused = connect(fd, reinterpret_cast<const sockaddr*>(&addr),
+                       sizeof(addr)) == -1 &&
+                   errno == ECONNREFUSED;
+    close(fd);
+    return refused;
+}
+
+static constexpr std::chrono::seconds RETRY { 1 };
+
+static uint64_t _get(const std::atomic<uint64_t>& counter) noexcept
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+namespace pcat
+{
+
+    metrics::metrics(const std::string& socket_path,
+        const std::string& file_path, const counters& counters) :
+        m_socket_path(socket_path),
+        m_file_path(file_path),
+        m_tmp_path(file_path + ".tmp"),
+        m_counters(counters),
+        m_listen_fd(-1),
+        m_stop_fd(-1),
+        m_errno(0),
+        m_back(),
+        m_front(),
+        m_front_mut()
+    {
+        m_back.reserve(BUFFER_SIZE);
+        m_front.reserve(BUFFER_SIZE);
+    }
+
+    metrics::~metrics() noexcept
+    {
+        if (m_listen_fd != -1)
+        {
+            close(m_listen_fd);
+            unlink(m_socket_path.c_str());
+        }
+        if (m_stop_fd != -1)
+        {
+            close(m_stop_fd);
+        }
+    }
+
+    bool metrics::open() noexcept
+    {
+        m_stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (m_stop_fd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        if (m_socket_path.empty())
+        {
+            return true;
+        }
+
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        if (m_socket_path.size() >= sizeof(addr.sun_path))
+        {
+            m_errno = ENAMETOOLONG;
+            return false;
+        }
+        std::memcpy(
+            addr.sun_path, m_socket_path.c_str(), m_socket_path.size() + 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        // A socket left by a killed instance would fail the bind, anything
+        // else at the path is kept and fails it with EADDRINUSE
+        if (_stale_socket(addr))
+        {
+            unlink(m_socket_path.c_str());
+        }
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+                -1 ||
+            listen(fd, 8) == -1)
+        {
+            m_errno = errno;
+            close(fd);
+            return false;
+        }
+
+        m_listen_fd = fd;
+        return true;
+    }
+
+    void metrics::update(float cpu_load, const history::stats& stats) noexcept
+    {
+        m_back.clear();
+
+        _append_metric(m_back, "polycat_cpu_load", "gauge",
+            "CPU load of the latest poll.", cpu_load);
+        _append_metric(m_back, "polycat_cpu_load_displayed", "gauge",
+            "Smoothed CPU load the animation runs at.",
+            m_counters.load_displayed.load(std::memory_order_relaxed));
+        _append_metric(m_back, "polycat_sleeping", "gauge",
+            "1 if the cat is sleeping, 0 otherwise.",
+            static_cast<uint64_t>(
+                m_counters.sleeping.load(std::memory_order_relaxed)));
+
+        _append_header(m_back, "polycat_cpu_load_window", "gauge",
+            "CPU load statistics over history_window.");
+        const std::pair<std::string_view, uint8_t> window[] = {
+            { "avg", stats.avg },
+            { "max", stats.max },
+            { "p95", stats.p95 },
+        };
+        for (const auto& [stat, value] : window)
+        {
+            m_back.append("polycat_cpu_load_window{stat=\"")
+                .append(stat)
+                .append("\"} ");
+            _append_number(m_back, static_cast<double>(value) / 100.0);
+            m_back.append("\n");
+        }
+
+        _append_metric(m_back, "polycat_frames_total", "counter",
+            "Frames emitted.", _get(m_counters.frames));
+        _append_metric(m_back, "polycat_frames_dropped_total", "counter",
+            "Frames dropped because the reader fell behind.",
+            _get(m_counters.dropped));
+        _append_metric(m_back, "polycat_frames_suppressed_total", "counter",
+            "Frames not written as they equal the previous one.",
+            _get(m_counters.suppressed));
+        _append_metric(m_back, "polycat_wakeups_total", "counter",
+            "Render loop wakeups.", _get(m_counters.wakeups));
+        _append_metric(m_back, "polycat_polls_total", "counter",
+            "CPU polls.", _get(m_counters.polls));
+        _append_metric(m_back, "polycat_poll_seconds_total", "counter",
+            "Time spent polling the CPU.",
+            static_cast<double>(_get(m_counters.poll_ns)) / 1e9);
+        _append_metric(m_back, "polycat_poll_max_seconds", "gauge",
+            "Longest CPU poll.",
+            static_cast<double>(_get(m_counters.poll_max_ns)) / 1e9);
+        _append_metric(m_back, "polycat_stat_read_bytes_total", "counter",
+            "Bytes read from the stat file.", _get(m_counters.stat_bytes));
+
+        _append_header(m_back, "polycat_syscalls_total", "counter",
+            "System calls made, sleeps and waits included.");
+        const std::pair<std::string_view, uint64_t> syscalls[] = {
+            { "stat", _get(m_counters.stat_syscalls) },
+            { "write", _get(m_counters.writes) },
+            { "sleep", _get(m_counters.sleeps) },
+            { "wait", _get(m_counters.waits) },
+        };
+        for (const auto& [call, value] : syscalls)
+        {
+            m_back.append("polycat_syscalls_total{call=\"")
+                .append(call)
+                .append("\"} ");
+            _append_number(m_back, value);
+            m_back.append("\n");
+        }
+
+        _append_header(m_back, "polycat_frame_lateness_seconds", "histogram",
+            "How late frames woke up.");
+        uint64_t count = 0;
+        for (size_t i = 0; i < m_counters.lateness.size(); i++)
+        {
+            count += _get(m_counters.lateness[i]);
+            m_back.append("polycat_frame_lateness_seconds_bucket{le=\"");
+            if (i < counters::LATENESS_BOUNDS.size())
+            {
+                _append_number(m_back,
+                    static_cast<double>(counters::LATENESS_BOUNDS[i]) / 1e6);
+            }
+            else
+            {
+                m_back.append("+Inf");
+            }
+            m_back.append("\"} ");
+            _append_number(m_back, count);
+            m_back.append("\n");
+        }
+        m_back.append("polycat_frame_lateness_seconds_sum ");
+        _append_number(m_back,
+            static_cast<double>(_get(m_counters.lateness_ns)) / 1e9);
+        m_back.append("\npolycat_frame_lateness_seconds_count ");
+        _append_number(m_back, count);
+        m_back.append("\n");
+
+        std::lock_guard guard(m_front_mut);
+        m_front.swap(m_back);
+    }
+
+    void metrics::run() noexcept
+    {
+        using namespace std::chrono;
+
+        pollfd fds[2] = {
+            { m_stop_fd, POLLIN, 0 },
+            { m_listen_fd, POLLIN, 0 },
+        };
+        nfds_t nfds = m_listen_fd != -1 ? 2 : 1;
+        auto next_write = steady_clock::now();
+
+        while (true)
+        {
+            int timeout = -1;
+            if (!m_file_path.empty())
+            {
+                auto now = steady_clock::now();
+                if (now >= next_write)
+                {
+                    // Retried soon if the first poll has not finished yet
+                    next_write = now + (write_file() ? FILE_PERIOD : RETRY);
+                    if (m_errno != 0)
+                    {
+                        return;
+                    }
+                }
+                timeout = static_cast<int>(
+                    ceil<milliseconds>(next_write - now).count());
+            }
+
+            int n = poll(fds, nfds, timeout);
+            if (n == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                m_errno = errno;
+                return;
+            }
+
+            if (fds[0].revents != 0)
+            {
+                return;
+            }
+
+            if (nfds == 2 && fds[1].revents != 0)
+            {
+                serve();
+            }
+        }
+    }
+
+    void metrics::stop() noexcept
+    {
+        uint64_t value = 1;
+        [[maybe_unused]] ssize_t n = write(m_stop_fd, &value, sizeof(value));
+    }
+
+    bool metrics::io_err() const noexcept { return m_errno != 0; }
+
+    const char* metrics::io_err_what() const noexcept
+    {
+        return m_errno != 0 ? std::strerror(m_errno) : "";
+    }
+
+    void metrics::serve() noexcept
+    {
+        int fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            return;
+        }
+
+        // A client gone before the write must not kill the process
+        {
+            std::lock_guard guard(m_front_mut);
+            [[maybe_unused]] ssize_t n =
+                send(fd, m_front.data(), m_front.size(), MSG_NOSIGNAL);
+        }
+        close(fd);
+    }
+
+    bool metrics::write_file() noexcept
+    {
+        std::unique_lock lock(m_front_mut);
+        if (m_front.empty())
+        {
+            return false;
+        }
+        lock.unlock();
+
+        int fd = ::open(
+            m_tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1)
+        {
+            m_errno = errno;
+            return true;
+        }
+
+        ssize_t n = 0;
+        size_t size = 0;
+        {
+            std::lock_guard guard(m_front_mut);
+            size = m_front.size();
+            n = write(fd, m_front.data(), size);
+        }
+
+        if (n != static_cast<ssize_t>(size))
+        {
+            m_errno = n == -1 ? errno : EIO;
+            close(fd);
+            unlink(m_tmp_path.c_str());
+            return true;
+        }
+
+        // node_exporter never sees a partial file
+        if (close(fd) == -1 ||
+            rename(m_tmp_path.c_str(), m_file_path.c_str()) == -1)
+        {
+            m_errno = errno;
+            unlink(m_tmp_path.c_str());
+        }
+        return true;
+    }
+
+}
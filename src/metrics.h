@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <mutex>
+
+#include "counters.h"
+#include "history.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Exports CPU load and runtime counters in the Prometheus text
+     * format, on a Unix socket and as a node_exporter textfile
+     *
+     * The snapshot is rendered on the poll thread after every poll, serving
+     * it costs a single write(2).
+     */
+    class metrics
+    {
+    public:
+        /**
+         * @brief Period of textfile updates
+         */
+        static constexpr std::chrono::seconds FILE_PERIOD { 15 };
+
+        static constexpr size_t BUFFER_SIZE = 4096;
+
+        /**
+         * @brief Constructs an instance
+         * @param socket_path Unix socket path, empty to not serve
+         * @param file_path Textfile path, empty to not write
+         * @param counters Counters to export
+         */
+        metrics(const std::string& socket_path, const std::string& file_path,
+            const counters& counters);
+
+        ~metrics() noexcept;
+
+        metrics(const metrics&) = delete;
+
+        metrics& operator=(const metrics&) = delete;
+
+        /**
+         * @brief Creates the socket, replacing a stale one left at the path
+         * @return true - on success, false - otherwise
+         */
+        bool open() noexcept;
+
+        /**
+         * @brief Renders the snapshot, called by the poll thread
+         * @param cpu_load Latest CPU load, value in range [0-1]
+         * @param stats Latest load history statistics
+         */
+        void update(float cpu_load, const history::stats& stats) noexcept;
+
+        /**
+         * @brief Serves the socket and writes the textfile until stopped or
+         * an IO error happens (should be run in separate thread)
+         */
+        void run() noexcept;
+
+        /**
+         * @brief Makes run() return, can be called from any thread
+         */
+        void stop() noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
+
+    private:
+        std::string m_socket_path;
+        std::string m_file_path;
+        std::string m_tmp_path;
+        const counters& m_counters;
+        int m_listen_fd;
+        int m_stop_fd;
+        int m_errno;
+        std::string m_back;
+        std::string m_front;
+        std::mutex m_front_mut;
+
+        /**
+         * @brief Writes the snapshot to an accepted connection
+         */
+        void serve() noexcept;
+
+        /**
+         * @brief Replaces the textfile with the snapshot atomically
+         * @return false - if there is no snapshot yet, true - otherwise
+         */
+        bool write_file() noexcept;
+    };
+
+}
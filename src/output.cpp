@@ -0,0 +1,157 @@
+#include "output.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace pcat
+{
+
+    output::output(int fd) noexcept :
+        m_fd(fd),
+        m_buf(),
+        m_off(0),
+        m_busy(false),
+        m_next(),
+        m_has_next(false),
+        m_last(),
+        m_has_last(false),
+        m_written(0),
+        m_dropped(0),
+        m_suppressed(0),
+        m_syscalls(0),
+        m_errno(0)
+    {
+        m_buf.reserve(BUFFER_SIZE);
+        m_next.reserve(BUFFER_SIZE);
+        m_last.reserve(BUFFER_SIZE);
+    }
+
+    bool output::open() noexcept
+    {
+        if (isatty(m_fd))
+        {
+            return true;
+        }
+
+        int flags = fcntl(m_fd, F_GETFL);
+        if (flags == -1 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        return true;
+    }
+
+    void output::write(std::string_view line) noexcept
+    {
+        if (m_errno != 0)
+        {
+            return;
+        }
+
+        if (m_busy)
+        {
+            flush();
+        }
+
+        if (m_has_last && line == m_last)
+        {
+            m_suppressed++;
+            return;
+        }
+        m_last.assign(line);
+        m_has_last = true;
+
+        if (m_busy)
+        {
+            if (m_off == 0)
+            {
+                // Nothing of the stale line reached the reader, replace it
+                m_dropped++;
+                assemble(m_buf, line);
+            }
+            else
+            {
+                // The stale line is partially written and has to be
+                // completed, keep only the newest line after it
+                if (m_has_next)
+                {
+                    m_dropped++;
+                }
+                assemble(m_next, line);
+                m_has_next = true;
+            }
+            return;
+        }
+
+        assemble(m_buf, line);
+        m_off = 0;
+        m_busy = true;
+        flush();
+    }
+
+    uint64_t output::written() const noexcept { return m_written; }
+
+    uint64_t output::dropped() const noexcept { return m_dropped; }
+
+    uint64_t output::suppressed() const noexcept { return m_suppressed; }
+
+    uint64_t output::syscalls() const noexcept { return m_syscalls; }
+
+    bool output::io_err() const noexcept { return m_errno != 0; }
+
+    const char* output::io_err_what() const noexcept
+    {
+        return m_errno != 0 ? std::strerror(m_errno) : "";
+    }
+
+    void output::flush() noexcept
+    {
+        while (m_busy)
+        {
+            ssize_t n =
+                ::write(m_fd, m_buf.data() + m_off, m_buf.size() - m_off);
+            m_syscalls++;
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    m_errno = errno;
+                    m_busy = false;
+                }
+                return;
+            }
+
+            m_off += static_cast<size_t>(n);
+            if (m_off < m_buf.size())
+            {
+                continue;
+            }
+
+            m_written++;
+            m_off = 0;
+            m_busy = m_has_next;
+            if (m_has_next)
+            {
+                m_buf.swap(m_next);
+                m_has_next = false;
+            }
+        }
+    }
+
+    void output::assemble(std::string& buf, std::string_view line) noexcept
+    {
+        buf.assign(line);
+        buf.push_back('\n');
+    }
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcat
+{
+
+    /**
+     * @brief Writes output lines to a file descriptor without blocking,
+     * keeping only the newest line when the reader falls behind
+     */
+    class output
+    {
+    public:
+        static constexpr size_t BUFFER_SIZE = 4096;
+
+        /**
+         * @brief Constructs an instance writing to specified descriptor
+         * @param fd File descriptor
+         */
+        output(int fd) noexcept;
+
+        /**
+         * @brief Switches the descriptor to non-blocking mode, terminals are
+         * left untouched as their mode is shared with the parent shell
+         * @return true - on success, false - otherwise
+         */
+        bool open() noexcept;
+
+        /**
+         * @brief Writes the line followed by a newline with a single write(2),
+         * drops stale lines if the descriptor is not writable, lines equal to
+         * the previous one are suppressed
+         * @param line Line without trailing newline
+         */
+        void write(std::string_view line) noexcept;
+
+        /**
+         * @brief Tells the number of lines written completely
+         */
+        uint64_t written() const noexcept;
+
+        /**
+         * @brief Tells the number of lines dropped because of backpressure
+         */
+        uint64_t dropped() const noexcept;
+
+        /**
+         * @brief Tells the number of lines suppressed as duplicates
+         */
+        uint64_t suppressed() const noexcept;
+
+        /**
+         * @brief Tells the number of write(2) calls made
+         */
+        uint64_t syscalls() const noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened during writing
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
+
+    private:
+        int m_fd;
+        std::string m_buf;
+        size_t m_off;
+        bool m_busy;
+        std::string m_next;
+        bool m_has_next;
+        std::string m_last;
+        bool m_has_last;
+        uint64_t m_written;
+        uint64_t m_dropped;
+        uint64_t m_suppressed;
+        uint64_t m_syscalls;
+        int m_errno;
+
+        /**
+         * @brief Writes as much of the current line as possible, continues
+         * with the next line once the current one is complete
+         */
+        void flush() noexcept;
+
+        /**
+         * @brief Assembles the line and a newline into buffer
+         */
+        static void assemble(std::string& buf, std::string_view line) noexcept;
+    };
+
+}
@@ -1,12 +1,16 @@
 #include "parse.h"
 
-#include <format>
-#include <fstream>
+#include "embedded_conf.h"
+
 #include <algorithm>
 #include <cctype>
 #include <charconv>
 #include <system_error>
 #include <variant>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 static size_t _ltrim(std::string& s)
 {
@@ -40,19 +44,23 @@ static size_t _trim(std::string& s)
     return _ltrim(s);
 }
 
-static pcat::parse::data_value _parse_value(
-    const std::string& s, pcat::parse::loc start_loc)
+static std::optional<pcat::parse::data_value> _parse_value(
+    const std::string& s, pcat::parse::loc start_loc,
+    std::vector<pcat::parse::err>& errors)
 {
     if (s.empty())
     {
-        throw pcat::parse::err(start_loc, "Empty value");
+        errors.push_back(pcat::parse::err(start_loc, "Empty value"));
+        return std::nullopt;
     }
 
     if (s[0] == '"')
     {
         if (s.length() < 2)
         {
-            throw pcat::parse::err(start_loc, "Unterminated string");
+            errors.push_back(
+                pcat::parse::err(start_loc, "Unterminated string"));
+            return std::nullopt;
         }
         if (s[s.length() - 1] == '"')
         {
@@ -60,8 +68,9 @@ static pcat::parse::data_value _parse_value(
         }
         else
         {
-            throw pcat::parse::err(
-                start_loc, "Last string character is not `\"`");
+            errors.push_back(pcat::parse::err(
+                start_loc, "Last string character is not `\"`"));
+            return std::nullopt;
         }
     }
     else if (s == "true")
@@ -79,7 +88,8 @@ static pcat::parse::data_value _parse_value(
             if (!std::isdigit(s[i]))
             {
                 pcat::parse::loc l(start_loc.l, start_loc.c + i);
-                throw pcat::parse::err(l, "Unexpected character");
+                errors.push_back(pcat::parse::err(l, "Unexpected character"));
+                return std::nullopt;
             }
         }
 
@@ -90,21 +100,42 @@ static pcat::parse::data_value _parse_value(
 
         if (ec == std::errc::invalid_argument)
         {
-            throw pcat::parse::err(start_loc, "Not an integer");
+            errors.push_back(pcat::parse::err(start_loc, "Not an integer"));
+            return std::nullopt;
         }
         else if (ec == std::errc::result_out_of_range)
         {
-            throw pcat::parse::err(start_loc, "Integer out of range");
+            errors.push_back(
+                pcat::parse::err(start_loc, "Integer out of range"));
+            return std::nullopt;
         }
         else if (ec != std::errc())
         {
-            throw pcat::parse::err(start_loc, "Error while parsing integer");
+            errors.push_back(
+                pcat::parse::err(start_loc, "Error while parsing integer"));
+            return std::nullopt;
         }
 
         return result;
     }
 }
 
+static const char* _type_name(const pcat::parse::data_value& value)
+{
+    if (std::holds_alternative<std::string>(value))
+    {
+        return "string";
+    }
+    else if (std::holds_alternative<int64_t>(value))
+    {
+        return "integer";
+    }
+    else
+    {
+        return "boolean";
+    }
+}
+
 namespace pcat
 {
 
@@ -129,7 +160,7 @@ namespace pcat
     const char* parse::err::what() const noexcept { return m_message.c_str(); }
 
     parse::no_key_err::no_key_err(const std::string& key) noexcept :
-        m_message(std::format("No key `{}` found", key))
+        m_message("No key `" + key + "` found")
     {
     }
 
@@ -140,9 +171,8 @@ namespace pcat
 
     parse::type_err::type_err(const std::string& key,
         const std::string& expected, const std::string& actual) noexcept :
-        m_message(std::format(
-            "Key `{}` is expected to be of type {}, but the actual type is {}",
-            key, expected, actual))
+        m_message("Key `" + key + "` is expected to be of type " + expected +
+                  ", but the actual type is " + actual)
     {
     }
 
@@ -161,26 +191,30 @@ namespace pcat
         m_values.clear();
 
         std::vector<err> errors;
-        std::ifstream file;
+        std::string text;
 
-        file.open(path);
-        if (file.fail())
+        read_err failed;
+        if (!read_file(path, text, failed))
         {
-            errors.push_back(err(std::format("Failed to open `{}`", path)));
+            const char* op = failed == read_err::OPEN ? "open" : "read";
+            errors.push_back(
+                err(std::string("Failed to ") + op + " `" + path + "`"));
             return errors;
         }
 
-        std::string line;
         loc l(0, 1);
-        while (std::getline(file, line))
+        size_t begin = 0;
+        while (begin < text.length())
         {
-            l.l++;
-            if (file.fail() || file.bad())
+            size_t end = text.find('\n', begin);
+            if (end == std::string::npos)
             {
-                errors.push_back(err(std::format("Failed to read `{}`", path)));
-                return errors;
+                end = text.length();
             }
+            std::string line = text.substr(begin, end - begin);
+            begin = end + 1;
 
+            l.l++;
             l.c = 1;
             size_t pos = _trim(line);
             l.c += pos;
@@ -202,19 +236,16 @@ namespace pcat
                 if (m_values.contains(key))
                 {
                     errors.push_back(
-                        err(l, std::format("Duplicate key `{}`", key)));
+                        err(l, "Duplicate key `" + key + "`"));
                 }
                 std::string value = line.substr(pos + 1, line.length() + 1);
                 size_t val_trim_pos = _trim(value);
                 l.c += pos + val_trim_pos + 1;
-                try
-                {
-                    data_value val = _parse_value(value, l);
-                    m_values[key] = val;
-                }
-                catch (const err& e)
+                std::optional<data_value> val =
+                    _parse_value(value, l, errors);
+                if (val)
                 {
-                    errors.push_back(e);
+                    m_values[key] = std::move(*val);
                 }
             }
         }
@@ -222,76 +253,88 @@ namespace pcat
         return errors;
     }
 
-    std::string parse::get_string(const std::string& key) const
+    std::vector<parse::err> parse::load_embedded() noexcept
     {
-        data_value value = get_value(key);
-        if (std::holds_alternative<std::string>(value))
-        {
-            return std::get<std::string>(value);
-        }
-        else if (std::holds_alternative<int64_t>(value))
-        {
-            throw type_err(key, "string", "integer");
-        }
-        else if (std::holds_alternative<bool>(value))
-        {
-            throw type_err(key, "string", "boolean");
-        }
-        else
+        m_values.clear();
+
+        std::vector<err> errors;
+        const embedded_conf::entries& entries = embedded_conf::get();
+
+        // Entries are validated at compile time, only values are converted
+        for (size_t i = 0; i < entries.count; i++)
         {
-            return "";
+            const embedded_conf::entry& entry = entries.list[i];
+            std::optional<data_value> val =
+                _parse_value(std::string(entry.value), loc(), errors);
+            if (val)
+            {
+                m_values[std::string(entry.key)] = std::move(*val);
+            }
         }
+
+        return errors;
     }
 
-    int64_t parse::get_int(const std::string& key) const
+    std::optional<std::string> parse::get_string(
+        const std::string& key, get_err& err) const
     {
-        data_value value = get_value(key);
-        if (std::holds_alternative<std::string>(value))
-        {
-            throw type_err(key, "integer", "string");
-        }
-        else if (std::holds_alternative<int64_t>(value))
+        std::optional<data_value> value = get_value(key);
+        if (!value)
         {
-            return std::get<int64_t>(value);
+            err = no_key_err(key);
+            return std::nullopt;
         }
-        else if (std::holds_alternative<bool>(value))
+        if (const std::string* s = std::get_if<std::string>(&*value))
         {
-            throw type_err(key, "integer", "boolean");
-        }
-        else
-        {
-            return 0;
+            return *s;
         }
+        err = type_err(key, "string", _type_name(*value));
+        return std::nullopt;
     }
 
-    bool parse::get_bool(const std::string& key) const
+    std::optional<int64_t> parse::get_int(
+        const std::string& key, get_err& err) const
     {
-        data_value value = get_value(key);
-        if (std::holds_alternative<std::string>(value))
+        std::optional<data_value> value = get_value(key);
+        if (!value)
         {
-            throw type_err(key, "boolean", "string");
+            err = no_key_err(key);
+            return std::nullopt;
         }
-        else if (std::holds_alternative<int64_t>(value))
+        if (const int64_t* i = std::get_if<int64_t>(&*value))
         {
-            throw type_err(key, "boolean", "integer");
+            return *i;
         }
-        else if (std::holds_alternative<bool>(value))
+        err = type_err(key, "integer", _type_name(*value));
+        return std::nullopt;
+    }
+
+    std::optional<bool> parse::get_bool(
+        const std::string& key, get_err& err) const
+    {
+        std::optional<data_value> value = get_value(key);
+        if (!value)
         {
-            return std::get<bool>(value);
+            err = no_key_err(key);
+            return std::nullopt;
         }
-        else
+        if (const bool* b = std::get_if<bool>(&*value))
         {
-            return false;
+            return *b;
         }
+        err = type_err(key, "boolean", _type_name(*value));
+        return std::nullopt;
     }
 
-    parse::data_value parse::get_value(const std::string& key) const
+    std::optional<parse::data_value> parse::get_value(
+        const std::string& key) const
     {
-        if (!has_key(key))
+        auto it = m_values.find(key);
+        if (it == m_values.end())
         {
-            throw no_key_err(key);
+            return std::nullopt;
         }
-        return m_values.at(key);
+        return it->second;
     }
 
     bool parse::has_key(const std::string& key) const
@@ -303,4 +346,64 @@ namespace pcat
     {
         return m_values;
     }
+
+    bool parse::read_file(
+        const std::string& path, std::string& text, read_err& err) noexcept
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            err = read_err::OPEN;
+            return false;
+        }
+
+        char buf[4096];
+        while (true)
+        {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0)
+            {
+                int read_errno = errno;
+                close(fd);
+                errno = read_errno;
+                err = read_err::READ;
+                return false;
+            }
+            if (n == 0)
+            {
+                close(fd);
+                return true;
+            }
+            text.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+    std::vector<std::string> parse::words(std::string_view text)
+    {
+        std::vector<std::string> words;
+        size_t pos = 0;
+        while (pos < text.length())
+        {
+            if (std::isspace(static_cast<unsigned char>(text[pos])))
+            {
+                pos++;
+                continue;
+            }
+
+            size_t end = pos;
+            while (end < text.length() &&
+                   !std::isspace(static_cast<unsigned char>(text[end])))
+            {
+                end++;
+            }
+            words.emplace_back(text.substr(pos, end - pos));
+            pos = end;
+        }
+        return words;
+    }
+
 }
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <cstdint>
 #include <variant>
-#include <exception>
+#include <optional>
 #include <vector>
 
 namespace pcat
@@ -47,9 +48,9 @@ namespace pcat
         };
 
         /**
-         * @brief Thrown on parsing errors
+         * @brief Describes a parsing error
          */
-        class err : public std::exception
+        class err
         {
         public:
             /**
@@ -77,7 +78,7 @@ namespace pcat
              */
             loc get_loc() const noexcept;
 
-            const char* what() const noexcept override;
+            const char* what() const noexcept;
 
         private:
             bool m_has_loc;
@@ -86,34 +87,39 @@ namespace pcat
         };
 
         /**
-         * @brief Thrown when no key found
+         * @brief Describes a missing key
          */
-        class no_key_err : public std::exception
+        class no_key_err
         {
         public:
             no_key_err(const std::string& key) noexcept;
 
-            const char* what() const noexcept override;
+            const char* what() const noexcept;
 
         private:
             std::string m_message;
         };
 
         /**
-         * @brief Thrown on type errors
+         * @brief Describes a value of unexpected type
          */
-        class type_err : public std::exception
+        class type_err
         {
         public:
             type_err(const std::string& key, const std::string& expected,
                 const std::string& actual) noexcept;
 
-            const char* what() const noexcept override;
+            const char* what() const noexcept;
 
         private:
             std::string m_message;
         };
 
+        /**
+         * @brief Reason a value could not be got, std::monostate if none
+         */
+        using get_err = std::variant<std::monostate, no_key_err, type_err>;
+
         using data_value = std::variant<std::string, int64_t, bool>;
 
         parse() noexcept;
@@ -125,40 +131,46 @@ namespace pcat
          */
         std::vector<err> load(const std::string& path) noexcept;
 
+        /**
+         * @brief Loads the default config embedded at build time, performs
+         * no file IO
+         * @return List of parsing errors occured
+         */
+        std::vector<err> load_embedded() noexcept;
+
         /**
          * @brief Gets the string value
          * @param key Key
-         * @return String value
-         * @exception pcat::parse::no_key_err
-         * @exception pcat::parse::type_err
+         * @param err Set to the reason on failure
+         * @return String value, std::nullopt on failure
          */
-        std::string get_string(const std::string& key) const;
+        std::optional<std::string> get_string(
+            const std::string& key, get_err& err) const;
 
         /**
          * @brief Gets the integer value
          * @param key Key
-         * @return Integer value
-         * @exception pcat::parse::no_key_err
-         * @exception pcat::parse::type_err
+         * @param err Set to the reason on failure
+         * @return Integer value, std::nullopt on failure
          */
-        int64_t get_int(const std::string& key) const;
+        std::optional<int64_t> get_int(
+            const std::string& key, get_err& err) const;
 
         /**
          * @brief Gets the boolean value
          * @param key Key
-         * @return Boolean value
-         * @exception pcat::parse::no_key_err
-         * @exception pcat::parse::type_err
+         * @param err Set to the reason on failure
+         * @return Boolean value, std::nullopt on failure
          */
-        bool get_bool(const std::string& key) const;
+        std::optional<bool> get_bool(
+            const std::string& key, get_err& err) const;
 
         /**
          * @brief Gets the value
          * @param key Key
-         * @return Value
-         * @exception pcat::parse::no_key_err
+         * @return Value, std::nullopt if there is no such key
          */
-        data_value get_value(const std::string& key) const;
+        std::optional<data_value> get_value(const std::string& key) const;
 
         /**
          * @brief Indicated whether the config has specified key
@@ -173,6 +185,32 @@ namespace pcat
          */
         std::unordered_map<std::string, data_value> values() const;
 
+        /**
+         * @brief Step of read_file that failed
+         */
+        enum class read_err : uint8_t
+        {
+            OPEN,
+            READ,
+        };
+
+        /**
+         * @brief Reads a whole file with read(2)
+         * @param path Path to file
+         * @param text Destination, the contents are appended
+         * @param err Set to the failed step on failure
+         * @return true - on success, false - otherwise, errno is set
+         */
+        static bool read_file(const std::string& path, std::string& text,
+            read_err& err) noexcept;
+
+        /**
+         * @brief Splits text into words separated by whitespace
+         * @param text Text
+         * @return Words in order
+         */
+        static std::vector<std::string> words(std::string_view text);
+
     private:
         std::unordered_map<std::string, data_value> m_values;
     };
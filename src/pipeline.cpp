@@ -0,0 +1,286 @@
+#include "pipeline.h"
+
+#include <chrono>
+#include <cmath>
+#include <optional>
+
+#include "smoother.h"
+#include "gauge.h"
+#include "alloc_audit.h"
+
+/**
+ * @brief Tells the cursor value and advances it
+ */
+static uint64_t _advance(uint64_t& cursor, uint64_t count) noexcept
+{
+    uint64_t curr = cursor;
+    cursor = (cursor + 1 == count) ? 0 : cursor + 1;
+    return curr;
+}
+
+namespace pcat
+{
+
+    pipeline::pipeline(rate_poll& rate_poll, output& output,
+        history::stats& stats, clock& clock, counters* counters,
+        trace* trace) noexcept :
+        m_rate_poll(rate_poll),
+        m_output(output),
+        m_stats(stats),
+        m_clock(clock),
+        m_counters(counters),
+        m_trace(trace),
+        m_ring(nullptr),
+        m_next(),
+        m_next_mut(),
+        m_pending(false),
+        m_stopped(false),
+        m_frame(0),
+        m_sleeping_frame(0),
+        m_sample(0),
+        m_history_sample(0),
+        m_sleeping(false),
+        m_load_displayed(0.0f)
+    {
+    }
+
+    pipeline::status pipeline::run(std::unique_ptr<const plan> plan)
+    {
+        static constexpr std::array<run_fn, 16> RUNS =
+            runs(std::make_index_sequence<16>());
+
+        alloc_audit::scope scope(alloc_audit::PHASE_FRAME);
+
+        if (m_trace != nullptr)
+        {
+            m_ring = m_trace->thread("render");
+        }
+
+        while (true)
+        {
+            size_t index = (plan->smoothing << 3) | (plan->sleeping << 2) |
+                           (plan->gauge << 1) | plan->dynamic;
+
+            status status = (this->*RUNS[index])(*plan);
+            if (status != status::RELOAD)
+            {
+                return status;
+            }
+
+            std::lock_guard guard(m_next_mut);
+            plan = std::move(m_next);
+            m_pending.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void pipeline::reload(std::unique_ptr<const plan> plan) noexcept
+    {
+        m_next_mut.lock();
+        m_next = std::move(plan);
+        m_pending.store(true, std::memory_order_release);
+        m_next_mut.unlock();
+
+        // Sleeping and gauge loops may be blocked on the poll
+        m_rate_poll.interrupt();
+    }
+
+    void pipeline::stop() noexcept
+    {
+        m_stopped.store(true, std::memory_order_relaxed);
+        m_rate_poll.interrupt();
+    }
+
+    template<bool Smoothing, bool Sleeping, bool Gauge, bool Dynamic>
+    pipeline::status pipeline::run(const plan& plan)
+    {
+        smoother smoother(
+            plan.smoothing_value, plan.smoothing_kernel, m_load_displayed);
+        gauge gauge(plan.framer.count(), plan.gauge_hysteresis);
+
+        // Frame counts may have changed with the plan
+        m_frame = m_frame < plan.framer.count() ? m_frame : 0;
+        m_sleeping_frame = m_sleeping_frame < plan.sleeping_framer.count()
+                             ? m_sleeping_frame
+                             : 0;
+        m_sleeping = Sleeping && m_sleeping;
+
+        std::string text;
+        std::string line;
+        if constexpr (Dynamic)
+        {
+            text.reserve(output::BUFFER_SIZE);
+            line.reserve(output::BUFFER_SIZE);
+        }
+
+        // Deadline of the last sleep, unset after waits on the poll
+        std::optional<clock::time_point> deadline;
+
+        while (true)
+        {
+            clock::time_point point = m_clock.now();
+
+            if (m_counters != nullptr)
+            {
+                m_counters->wakeups.fetch_add(1, std::memory_order_relaxed);
+                if (deadline)
+                {
+                    m_counters->add_lateness(point - *deadline);
+                }
+            }
+
+            if (m_stopped.load(std::memory_order_relaxed))
+            {
+                return status::STOPPED;
+            }
+
+            if (m_pending.load(std::memory_order_acquire))
+            {
+                return status::RELOAD;
+            }
+
+            if (m_rate_poll.io_err())
+            {
+                return status::POLL_IO_ERR;
+            }
+
+            if (m_rate_poll.fmt_err())
+            {
+                return status::POLL_FMT_ERR;
+            }
+
+            if (m_output.io_err())
+            {
+                return status::OUTPUT_IO_ERR;
+            }
+
+            float load = m_rate_poll.poll();
+            float load_displayed = load;
+
+            if constexpr (Smoothing)
+            {
+                trace::span span(m_ring, "smoother");
+                smoother.target(load);
+                load_displayed = smoother.value(point);
+            }
+            if (!std::isnan(load_displayed))
+            {
+                m_load_displayed = load_displayed;
+            }
+
+            // Change sleeping state
+            if constexpr (Sleeping)
+            {
+                trace::span span(m_ring, "sleeping");
+                float threshold = m_sleeping ? plan.wakeup_threshold
+                                             : plan.sleeping_threshold;
+                m_sleeping = load_displayed <= threshold;
+            }
+
+            uint8_t load_percent = formatter::percent(load);
+            const framer* frames = &plan.framer;
+            const render_table* lines = &plan.table;
+            uint64_t index = 0;
+
+            // Set the period and pick the cat
+            if constexpr (Gauge)
+            {
+                index = gauge.bucket(load_displayed);
+            }
+            else
+            {
+                if (!m_sleeping)
+                {
+                    point += plan.rate_curve.period(load_displayed);
+                    index = _advance(m_frame, plan.framer.count());
+                }
+                else
+                {
+                    point += plan.sleeping_period;
+                    frames = &plan.sleeping_framer;
+                    lines = &plan.sleeping_table;
+                    index = _advance(
+                        m_sleeping_frame, plan.sleeping_framer.count());
+                }
+            }
+
+            // Print the cat
+            if constexpr (Dynamic)
+            {
+                {
+                    trace::span span(m_ring, "format");
+                    m_history_sample =
+                        m_rate_poll.get_history(m_stats, m_history_sample);
+
+                    text.clear();
+                    plan.formatter.format(
+                        text, { frames->at(index), load_percent });
+                    line.clear();
+                    plan.backend.serialize(
+                        line, { text, load_percent, m_sleeping });
+                }
+
+                trace::span span(m_ring, "write");
+                m_output.write(line);
+            }
+            else
+            {
+                trace::span span(m_ring, "write");
+                m_output.write(lines->get(index, load_percent));
+            }
+
+            if (m_counters != nullptr)
+            {
+                m_counters->frames.fetch_add(1, std::memory_order_relaxed);
+                m_counters->dropped.store(
+                    m_output.dropped(), std::memory_order_relaxed);
+                m_counters->suppressed.store(
+                    m_output.suppressed(), std::memory_order_relaxed);
+                m_counters->writes.store(
+                    m_output.syscalls(), std::memory_order_relaxed);
+                m_counters->load_displayed.store(
+                    m_load_displayed, std::memory_order_relaxed);
+                m_counters->sleeping.store(
+                    m_sleeping, std::memory_order_relaxed);
+            }
+
+            // The frame only changes with the load
+            if constexpr (Gauge)
+            {
+                trace::span span(m_ring, "wait");
+                if (m_counters != nullptr)
+                {
+                    m_counters->waits.fetch_add(1, std::memory_order_relaxed);
+                }
+                m_sample = m_rate_poll.wait_sample(m_sample);
+                deadline.reset();
+                continue;
+            }
+
+            deadline = point;
+
+            // Block until the load can wake the cat up instead of polling
+            if constexpr (Sleeping)
+            {
+                if (m_sleeping && plan.sleeping_static)
+                {
+                    trace::span span(m_ring, "wait");
+                    if (m_counters != nullptr)
+                    {
+                        m_counters->waits.fetch_add(
+                            1, std::memory_order_relaxed);
+                    }
+                    m_rate_poll.wait_above(plan.wakeup_threshold);
+                    deadline.reset();
+                }
+            }
+
+            trace::span span(m_ring, "sleep");
+            if (m_counters != nullptr)
+            {
+                m_counters->sleeps.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_clock.sleep_until(point);
+        }
+    }
+
+}
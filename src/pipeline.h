@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <array>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "plan.h"
+#include "rate_poll.h"
+#include "output.h"
+#include "history.h"
+#include "counters.h"
+#include "trace.h"
+#include "clock.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Render loop specialized for every combination of features
+     */
+    class pipeline
+    {
+    public:
+        /**
+         * @brief Reason the loop stopped
+         */
+        enum class status
+        {
+            POLL_IO_ERR,
+            POLL_FMT_ERR,
+            OUTPUT_IO_ERR,
+            // stop() was called
+            STOPPED,
+            // A new plan was published, handled by run()
+            RELOAD,
+        };
+
+        /**
+         * @brief Constructs an instance
+         * @param rate_poll Running CPU poll
+         * @param output Output to write lines to
+         * @param stats History statistics the plan keys display
+         * @param clock Clock to time frames with, the poll must run on it too
+         * @param counters Runtime counters, nullptr to disable counting
+         * @param trace Trace to record phases into, nullptr to disable tracing
+         */
+        pipeline(rate_poll& rate_poll, output& output, history::stats& stats,
+            clock& clock, counters* counters, trace* trace) noexcept;
+
+        /**
+         * @brief Runs the loop specialized for the plan until it stops,
+         * switches to published plans between frames
+         * @param plan Resolved config
+         * @return Reason the loop stopped
+         */
+        status run(std::unique_ptr<const plan> plan);
+
+        /**
+         * @brief Publishes a plan to be run from the next frame on, can be
+         * called from any thread
+         * @param plan Resolved config
+         */
+        void reload(std::unique_ptr<const plan> plan) noexcept;
+
+        /**
+         * @brief Makes the loop return before the next frame, can be called
+         * from any thread
+         */
+        void stop() noexcept;
+
+    private:
+        using run_fn = status (pipeline::*)(const plan&);
+
+        rate_poll& m_rate_poll;
+        output& m_output;
+        history::stats& m_stats;
+        clock& m_clock;
+        counters* m_counters;
+        trace* m_trace;
+        trace::ring* m_ring;
+        std::unique_ptr<const plan> m_next;
+        std::mutex m_next_mut;
+        std::atomic<bool> m_pending;
+        std::atomic<bool> m_stopped;
+
+        // Kept across plans so a reload does not restart the animation
+        uint64_t m_frame;
+        uint64_t m_sleeping_frame;
+        uint64_t m_sample;
+        uint64_t m_history_sample;
+        bool m_sleeping;
+        float m_load_displayed;
+
+        template<bool Smoothing, bool Sleeping, bool Gauge, bool Dynamic>
+        status run(const plan& plan);
+
+        /**
+         * @brief Lists loops indexed by feature bits
+         */
+        template<size_t... I>
+        static constexpr std::array<run_fn, sizeof...(I)> runs(
+            std::index_sequence<I...>)
+        {
+            return { &pipeline::run<(I & 8) != 0, (I & 4) != 0, (I & 2) != 0,
+                (I & 1) != 0>... };
+        }
+    };
+
+}
@@ -0,0 +1,108 @@
+#include "plan.h"
+
+#include <algorithm>
+
+namespace pcat
+{
+
+    std::unique_ptr<const plan> plan::make(
+        const conf& conf, const history::stats& stats, fmt_err& err)
+    {
+        // Formatter keys point into the instance, it is resolved in place
+        std::unique_ptr<plan> p(new plan(conf));
+
+        if (!p->gradient.set(conf.color_stops(), conf.color_markup()))
+        {
+            err = { fmt_err::source::COLOR, p->gradient.fmt_err_what() };
+            return nullptr;
+        }
+        p->gradient.add_keys(p->formatter);
+        history::add_keys(p->formatter, stats);
+
+        // Bare frames are formatted as a single frame key
+        if (!p->formatter.set(conf.format_enabled()
+                    ? conf.format()
+                    : formatter::FORMAT_PREFIX + formatter::FRAME_KEY))
+        {
+            err = { fmt_err::source::FORMAT, p->formatter.fmt_err_what() };
+            return nullptr;
+        }
+        if (!p->framer.set(conf.frames(), conf.frames_separator()))
+        {
+            err = { fmt_err::source::FRAMES, p->framer.fmt_err_what() };
+            return nullptr;
+        }
+        if (!p->sleeping_framer.set(
+                conf.sleeping_frames(), conf.frames_separator()))
+        {
+            err = { fmt_err::source::FRAMES,
+                p->sleeping_framer.fmt_err_what() };
+            return nullptr;
+        }
+        if (!p->rate_curve.set(
+                conf.rate_curve(), conf.low_rate(), conf.high_rate()))
+        {
+            err = { fmt_err::source::RATE_CURVE,
+                p->rate_curve.fmt_err_what() };
+            return nullptr;
+        }
+
+        // Nothing visible can change while sleeping on a single frame that
+        // does not display the CPU load, neither in the text nor in the
+        // backend fields
+        uint8_t deps = p->formatter.deps() | p->backend.deps();
+        p->sleeping_static =
+            p->sleeping_framer.count() == 1 &&
+            !(deps & (formatter::DEP_LOAD | formatter::DEP_HISTORY));
+
+        // History keys change with samples, such lines are rendered every
+        // frame, every other line is rendered once here
+        p->dynamic = deps & formatter::DEP_HISTORY;
+        p->history_shown = p->dynamic;
+        if (!p->dynamic)
+        {
+            p->table =
+                render_table(p->framer, p->formatter, p->backend, false);
+            p->sleeping_table = render_table(
+                p->sleeping_framer, p->formatter, p->backend, true);
+        }
+
+        return p;
+    }
+
+    plan::plan(const conf& conf) noexcept :
+        smoothing(conf.smoothing_enabled()),
+        sleeping(conf.sleeping_enabled() && conf.mode() != conf::MODE_GAUGE),
+        gauge(conf.mode() == conf::MODE_GAUGE),
+        dynamic(false),
+        sleeping_static(false),
+        sleeping_threshold(conf.sleeping_threshold() / 100.0f),
+        wakeup_threshold(conf.wakeup_threshold() / 100.0f),
+        sleeping_period(std::chrono::nanoseconds(1'000'000'000) /
+                        conf.sleeping_rate()),
+        smoothing_value(conf.smoothing_value()),
+        smoothing_kernel(conf.smoothing_kernel()),
+        gauge_hysteresis(conf.gauge_hysteresis() / 100.0f),
+        poll_period(conf.poll_period()),
+        history_shown(false),
+        // Statistics are kept over the window, but at least for one sample
+        history_capacity(std::max<uint64_t>(
+            conf.history_window() * 1000 / conf.poll_period(), 1)),
+        spark_length(conf.spark_length()),
+        gradient(),
+        formatter(),
+        backend(conf.output()),
+        framer(),
+        sleeping_framer(),
+        rate_curve(),
+        table(),
+        sleeping_table()
+    {
+    }
+
+    uint64_t plan::history_samples(bool metrics) const noexcept
+    {
+        return history_shown || metrics ? history_capacity : 0;
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+
+#include "conf.h"
+#include "framer.h"
+#include "formatter.h"
+#include "backend.h"
+#include "gradient.h"
+#include "history.h"
+#include "rate_curve.h"
+#include "render_table.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Config resolved into immutable data used by the render loop
+     */
+    struct plan
+    {
+        /**
+         * @brief Describes the config value that could not be resolved
+         */
+        struct fmt_err
+        {
+            enum class source : uint8_t
+            {
+                FORMAT,
+                FRAMES,
+                COLOR,
+                RATE_CURVE,
+            };
+
+            source from;
+            std::string message;
+        };
+
+        /**
+         * @brief Resolves the config, renders output tables
+         * @param conf Loaded config
+         * @param stats History statistics displayed by history keys
+         * @param err Set on failure
+         * @return Plan, nullptr on failure
+         */
+        static std::unique_ptr<const plan> make(
+            const conf& conf, const history::stats& stats, fmt_err& err);
+
+        /**
+         * @brief Tells the number of samples the load history has to keep
+         * @param metrics Whether exported metrics show history statistics
+         * @return Samples over the history window, 0 if nothing shows them
+         */
+        uint64_t history_samples(bool metrics) const noexcept;
+
+        // Formatter keys point into the instance
+        plan(const plan&) = delete;
+
+        plan& operator=(const plan&) = delete;
+
+        bool smoothing;
+        bool sleeping;
+        bool gauge;
+        bool dynamic;
+        bool sleeping_static;
+
+        float sleeping_threshold;
+        float wakeup_threshold;
+        std::chrono::nanoseconds sleeping_period;
+        uint64_t smoothing_value;
+        std::string smoothing_kernel;
+        float gauge_hysteresis;
+        uint64_t poll_period;
+        bool history_shown;
+        uint64_t history_capacity;
+        uint8_t spark_length;
+
+        pcat::gradient gradient;
+        pcat::formatter formatter;
+        pcat::backend backend;
+        pcat::framer framer;
+        pcat::framer sleeping_framer;
+        pcat::rate_curve rate_curve;
+        pcat::render_table table;
+        pcat::render_table sleeping_table;
+
+    private:
+        /**
+         * @brief Copies config values, make() resolves the rest
+         */
+        plan(const conf& conf) noexcept;
+    };
+
+}
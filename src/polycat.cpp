@@ -1,197 +1,658 @@
 #include <functional>
-#include <iostream>
+#include <cerrno>
 #include <cstdlib>
 #include <cstdint>
-#include <clocale>
+#include <cstring>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <initializer_list>
 #include <thread>
-#include <chrono>
-#include <cmath>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "args.h"
 #include "conf.h"
 #include "framer.h"
-#include "smoother.h"
 #include "formatter.h"
 #include "rate_poll.h"
 #include "parse.h"
+#include "output.h"
+#include "gradient.h"
+#include "history.h"
+#include "rate_curve.h"
+#include "plan.h"
+#include "pipeline.h"
+#include "conf_watch.h"
+#include "counters.h"
+#include "trace.h"
+#include "alloc_audit.h"
+#include "load_profile.h"
+#include "simulation.h"
+#include "metrics.h"
+#include "recorder.h"
 
-uint64_t get_period(uint64_t low_rate, uint64_t high_rate, float cpu_load);
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
 
-int main(int argc, char** argv)
+/**
+ * @brief Writes the text with write(2), waits while a non-blocking
+ * descriptor is full
+ */
+static void _write(int fd, std::string_view text)
 {
-    std::setlocale(LC_ALL, "");
-
-    pcat::args args(argc, argv);
-
-    try
+    while (!text.empty())
     {
-        args.parse();
+        ssize_t n = write(fd, text.data(), text.size());
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // Standard streams may share the output's non-blocking file
+            pollfd pfd = { fd, POLLOUT, 0 };
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return;
+        }
+        text.remove_prefix(static_cast<size_t>(n));
     }
-    catch (pcat::args::parse_err& e)
+}
+
+/**
+ * @brief Writes a line made of the parts to stderr with a single write
+ */
+static void _err(std::initializer_list<std::string_view> parts)
+{
+    std::string line;
+    for (std::string_view part : parts)
     {
-        std::cerr << "Argument error: " << e.what() << std::endl;
-        std::cerr << "Use `polycat --help` to see usage" << std::endl;
-        return EXIT_FAILURE;
+        line += part;
     }
+    line += "\n";
+    _write(STDERR_FILENO, line);
+}
 
-    if (args.help())
+/**
+ * @brief Loads the config, prints errors
+ * @return true - on success, false - otherwise
+ */
+static bool _load_conf(const pcat::args& args, pcat::conf& conf)
+{
+    pcat::conf::load_errs conf_load_errs = conf.load();
+
+    if (!conf_load_errs.any())
     {
-        std::cout << pcat::args::HELP_TEXT << std::endl;
-        return EXIT_SUCCESS;
+        return true;
     }
 
-    if (args.version())
+    _err({ "Config error: File loaded unsuccessfully" });
+    for (const pcat::parse::err& e : conf_load_errs.parse_errs)
     {
-        std::cout << "polycat v" POLYCAT_VERSION << std::endl;
-        return EXIT_SUCCESS;
+        std::string loc;
+        if (e.has_loc())
+        {
+            loc = std::to_string(e.get_loc().l) + ":" +
+                  std::to_string(e.get_loc().c) + ":";
+        }
+        _err({ args.conf_name(), ":", loc, " Parse error: ", e.what() });
+    }
+    for (const pcat::parse::no_key_err& e : conf_load_errs.no_key_errs)
+    {
+        _err({ args.conf_name(), ": ", e.what() });
+    }
+    for (const pcat::parse::type_err& e : conf_load_errs.type_errs)
+    {
+        _err({ args.conf_name(), ": Type error: ", e.what() });
+    }
+    for (const pcat::conf::fmt_err& e : conf_load_errs.fmt_errs)
+    {
+        _err({ args.conf_name(), ": Format error: ", e.what() });
     }
 
-    pcat::conf conf(args.conf_path());
+    return false;
+}
 
-    pcat::conf::load_errs conf_load_errs = conf.load();
+/**
+ * @brief Resolves the config into a plan, prints errors
+ * @return Plan on success, nullptr otherwise
+ */
+static std::unique_ptr<const pcat::plan> _make_plan(const pcat::args& args,
+    const pcat::conf& conf, const pcat::history::stats& history_stats)
+{
+    using source = pcat::plan::fmt_err::source;
 
-    if (conf_load_errs.any())
+    pcat::plan::fmt_err err;
+    std::unique_ptr<const pcat::plan> plan =
+        pcat::plan::make(conf, history_stats, err);
+
+    if (plan == nullptr)
     {
-        std::cerr << "Config error: File loaded unsuccessfully" << std::endl;
-        for (const pcat::parse::err& e : conf_load_errs.parse_errs)
+        switch (err.from)
         {
-            std::cerr << args.conf_path() << ":";
-            if (e.has_loc())
+        case source::FORMAT:
+            _err({ args.conf_name(), ": Format error: ", err.message });
+            break;
+        case source::FRAMES:
+            _err({ args.conf_name(), ": Frames error: ", err.message });
+            break;
+        case source::COLOR:
+            _err({ args.conf_name(), ": Color error: ", err.message });
+            break;
+        case source::RATE_CURVE:
+            _err({ args.conf_name(), ": Rate curve error: ", err.message });
+            break;
+        }
+    }
+
+    return plan;
+}
+
+/**
+ * @brief Reloads the config on every change until the watch stops, keeps
+ * the running config if the new one is invalid
+ */
+static void _watch_conf(const pcat::args& args, const pcat::conf& conf,
+    pcat::conf_watch& conf_watch, pcat::rate_poll& rate_poll,
+    pcat::pipeline& pipeline, const pcat::history::stats& history_stats,
+    bool export_metrics)
+{
+    while (conf_watch.wait())
+    {
+        pcat::conf new_conf(args.conf_path());
+        std::unique_ptr<const pcat::plan> plan;
+
+        if (_load_conf(args, new_conf))
+        {
+            // The header of the running output was already written
+            if (new_conf.output() == conf.output())
+            {
+                plan = _make_plan(args, new_conf, history_stats);
+            }
+            else
             {
-                std::cerr << e.get_loc().l << ":" << e.get_loc().c << ":";
+                _err({ args.conf_name(),
+                    ": Config error: `output` cannot be changed while "
+                    "running" });
             }
-            std::cerr << " Parse error: " << e.what() << std::endl;
         }
-        for (const pcat::parse::no_key_err& e : conf_load_errs.no_key_errs)
+
+        if (plan == nullptr)
         {
-            std::cerr << args.conf_path() << ": ";
-            std::cerr << e.what() << std::endl;
+            _err({ args.conf_name(),
+                ": Config reload failed, keeping the running config" });
+            continue;
         }
-        for (const pcat::parse::type_err& e : conf_load_errs.type_errs)
+
+        rate_poll.configure(plan->poll_period,
+            plan->history_samples(export_metrics), plan->spark_length);
+        pipeline.reload(std::move(plan));
+    }
+
+    if (conf_watch.io_err())
+    {
+        _err({ args.conf_name(), ": Config watch error: ",
+            conf_watch.io_err_what() });
+    }
+}
+
+/**
+ * @brief Runs the plan against the load profile on virtual time, prints
+ * the report to stdout
+ * @return Exit code
+ */
+static int _simulate(const pcat::args& args,
+    std::unique_ptr<const pcat::plan> plan, pcat::history::stats& history_stats)
+{
+    pcat::load_profile profile;
+
+    if (!profile.load(args.simulate_path()))
+    {
+        _err({ args.simulate_path(),
+            profile.io_err() ? ": Profile IO error: " : ": Profile error: ",
+            profile.err_what() });
+        return EXIT_FAILURE;
+    }
+
+    std::string report;
+    pcat::simulation simulation(profile, report);
+    pcat::pipeline::status status =
+        simulation.run(std::move(plan), history_stats);
+    _write(STDOUT_FILENO, report);
+
+    if (status != pcat::pipeline::status::STOPPED)
+    {
+        _err({ "Simulation output error" });
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Exports metrics until stopped, prints the error that stopped the
+ * export
+ */
+static void _export_metrics(const pcat::args& args, pcat::metrics& metrics)
+{
+    metrics.run();
+
+    if (metrics.io_err())
+    {
+        // Textfile writes are the only errors after the socket is created
+        std::string path = args.metrics_file_path();
+        _err({ path, path.empty() ? "" : ": ", "Metrics error: ",
+            metrics.io_err_what() });
+    }
+}
+
+/**
+ * @brief Resolves `--since` into milliseconds since the Unix epoch
+ * @param since Time of day `HH:MM`, the latest one not in the future, or a
+ * time ago `<number><s|m|h|d>`
+ * @param now Current time in milliseconds since the Unix epoch
+ * @return true - on success, false - if malformed
+ */
+static bool _parse_since(const std::string& since, int64_t now, int64_t& time)
+{
+    static constexpr std::pair<char, int64_t> UNITS[] = {
+        { 's', 1'000 },
+        { 'm', 60'000 },
+        { 'h', 3'600'000 },
+        { 'd', 86'400'000 },
+    };
+
+    const char* end = since.data() + since.size();
+    int64_t value = 0;
+    auto [ptr, ec] = std::from_chars(since.data(), end, value);
+    if (ec != std::errc() || value < 0 || ptr == end)
+    {
+        return false;
+    }
+
+    if (ptr + 1 == end)
+    {
+        for (const auto& [suffix, scale] : UNITS)
         {
-            std::cerr << args.conf_path() << ": ";
-            std::cerr << "Type error: " << e.what() << std::endl;
+            if (*ptr == suffix)
+            {
+                if (value > INT64_MAX / scale)
+                {
+                    return false;
+                }
+                time = now - value * scale;
+                return true;
+            }
         }
-        for (const pcat::conf::fmt_err& e : conf_load_errs.fmt_errs)
+        return false;
+    }
+
+    int64_t minute = 0;
+    auto [min_ptr, min_ec] = std::from_chars(ptr + 1, end, minute);
+    if (*ptr != ':' || min_ec != std::errc() || min_ptr != end ||
+        end - ptr != 3 || value > 23 || minute < 0 || minute > 59)
+    {
+        return false;
+    }
+
+    time_t now_s = now / 1000;
+    tm local;
+    localtime_r(&now_s, &local);
+    for (int days_ago = 0; days_ago < 2; days_ago++)
+    {
+        tm at = local;
+        at.tm_mday -= days_ago;
+        at.tm_hour = static_cast<int>(value);
+        at.tm_min = static_cast<int>(minute);
+        at.tm_sec = 0;
+        at.tm_isdst = -1;
+        time = static_cast<int64_t>(mktime(&at)) * 1000;
+        if (time <= now)
         {
-            std::cerr << args.conf_path() << ": ";
-            std::cerr << "Format error: " << e.what() << std::endl;
+            break;
         }
+    }
+    return true;
+}
+
+/**
+ * @brief Prints the recorded CPU load to stdout, one sample per line
+ * @return Exit code
+ */
+static int _print_history(const pcat::args& args)
+{
+    using namespace std::chrono;
 
+    std::string path = pcat::recorder::default_path();
+    if (path.empty())
+    {
+        _err({ "History error: XDG_RUNTIME_DIR is not set" });
         return EXIT_FAILURE;
     }
 
-    pcat::formatter formatter;
-
-    try
+    int64_t now =
+        duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+            .count();
+    int64_t since = std::numeric_limits<int64_t>::min();
+    if (!args.since().empty() && !_parse_since(args.since(), now, since))
     {
-        formatter.set(conf.format());
+        _err({ "Argument error: Parameter `--since` expected a time of day "
+               "or a time ago, but got `",
+            args.since(), "`" });
+        _err({ "Use `polycat --help` to see usage" });
+        return EXIT_FAILURE;
     }
-    catch (pcat::formatter::fmt_err& e)
+
+    int read_err = 0;
+    std::optional<std::vector<pcat::recorder::sample>> samples =
+        pcat::recorder::read(path, read_err);
+    if (!samples)
     {
-        std::cerr << args.conf_path() << ": Format error: " << e.what()
-                  << std::endl;
+        if (read_err != 0)
+        {
+            _err({ path, ": History IO error: ", std::strerror(read_err) });
+        }
+        else
+        {
+            _err({ path, ": History error: Not a polycat history file" });
+        }
         return EXIT_FAILURE;
     }
 
-    pcat::framer framer(conf.frames());
-    pcat::framer sleeping_framer(conf.sleeping_frames());
-    pcat::rate_poll rate_poll(conf.poll_period(), args.stat_path());
-    pcat::smoother smoother(conf.smoothing_value());
+    std::string out;
+    for (const pcat::recorder::sample& sample : *samples)
+    {
+        if (sample.time < since)
+        {
+            continue;
+        }
 
-    uint64_t low_rate = conf.low_rate();
-    uint64_t high_rate = conf.high_rate();
+        time_t time = sample.time / 1000;
+        tm local;
+        char buf[32];
+        localtime_r(&time, &local);
+        size_t n = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &local);
+        out.append(buf, n);
+        out += " " + std::to_string(sample.load / 10) + "." +
+               std::to_string(sample.load % 10) + "%\n";
+    }
+    _write(STDOUT_FILENO, out);
 
-    std::thread poll_thread([](pcat::rate_poll& rate_poll) { rate_poll.run(); },
-        std::ref(rate_poll));
+    return EXIT_SUCCESS;
+}
 
-    bool err = false;
-    uint64_t period_prev = get_period(low_rate, high_rate, 0.0f);
-    bool sleeping = false;
-    while (true)
+/**
+ * @brief Prints the counters to stderr
+ */
+static void _print_counters(const pcat::counters& counters)
+{
+    std::string report;
+    counters.report(report);
+    if constexpr (pcat::alloc_audit::ENABLED)
     {
-        using namespace std::chrono;
-        auto point = steady_clock::now();
+        pcat::alloc_audit::report(report);
+    }
+    _write(STDERR_FILENO, report);
+}
 
-        if (rate_poll.io_err())
+/**
+ * @brief Prints the counters on SIGUSR2, prints them, closes the trace and
+ * terminates on SIGTERM and SIGINT
+ * @param signals Signals blocked in every thread
+ * @param counters Counters, may be nullptr
+ * @param trace Trace, may be nullptr
+ */
+static void _handle_signals(
+    sigset_t signals, const pcat::counters* counters, pcat::trace* trace)
+{
+    while (true)
+    {
+        int number = 0;
+        if (sigwait(&signals, &number) != 0)
         {
-            std::cerr << args.stat_path()
-                      << ": CPU polling error: " << rate_poll.io_err_what()
-                      << std::endl;
-            err = true;
-            break;
+            continue;
         }
 
-        if (rate_poll.fmt_err())
+        if (counters != nullptr)
         {
-            std::cerr << args.stat_path() << ": " << rate_poll.fmt_err_what()
-                      << std::endl;
-            err = true;
-            break;
+            _print_counters(*counters);
         }
 
-        float load = rate_poll.poll();
-        smoother.target(load);
-        float load_smoothed = smoother.value(period_prev);
-        float load_displayed = conf.smoothing_enabled() ? load_smoothed : load;
-
-        // Change sleeping state
-        if (!sleeping)
+        if (number != SIGUSR2)
         {
-            sleeping = conf.sleeping_enabled()
-                         ? load_displayed <= conf.sleeping_threshold() / 100.0f
-                         : false;
+            if (trace != nullptr)
+            {
+                trace->close();
+            }
+
+            // Terminate the way the signal would
+            signal(number, SIG_DFL);
+            pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+            raise(number);
         }
-        else
+    }
+}
+
+int main(int argc, char** argv)
+{
+    pcat::args args(argc, argv);
+
+    if (!args.parse())
+    {
+        _err({ "Argument error: ", args.parse_err_what() });
+        _err({ "Use `polycat --help` to see usage" });
+        return EXIT_FAILURE;
+    }
+
+    if (args.help())
+    {
+        _write(STDOUT_FILENO, pcat::args::HELP_TEXT + "\n");
+        return EXIT_SUCCESS;
+    }
+
+    if (args.version())
+    {
+        _write(STDOUT_FILENO, "polycat v" POLYCAT_VERSION "\n");
+        return EXIT_SUCCESS;
+    }
+
+    if (args.history())
+    {
+        return _print_history(args);
+    }
+
+    pcat::conf conf(args.conf_path());
+
+    if (!_load_conf(args, conf))
+    {
+        return EXIT_FAILURE;
+    }
+
+    pcat::history::stats history_stats;
+    std::unique_ptr<const pcat::plan> plan =
+        _make_plan(args, conf, history_stats);
+
+    if (plan == nullptr)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (!args.simulate_path().empty())
+    {
+        return _simulate(args, std::move(plan), history_stats);
+    }
+
+    std::unique_ptr<pcat::counters> counters;
+    std::unique_ptr<pcat::trace> trace;
+    bool export_metrics = !args.metrics_socket_path().empty() ||
+                          !args.metrics_file_path().empty();
+    bool handle_signals = args.stats() || !args.trace_path().empty();
+    sigset_t signals;
+
+    // Signals are blocked before any thread starts, so only the signal
+    // thread receives them
+    if (handle_signals)
+    {
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGUSR2);
+        sigaddset(&signals, SIGTERM);
+        sigaddset(&signals, SIGINT);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    }
+
+    // Metrics export the counters too
+    if (args.stats() || export_metrics)
+    {
+        counters = std::make_unique<pcat::counters>();
+    }
+
+    if (!args.trace_path().empty())
+    {
+        trace = std::make_unique<pcat::trace>();
+        if (!trace->open(args.trace_path()))
         {
-            sleeping = (load_displayed <= conf.wakeup_threshold() / 100.0f);
+            _err({ args.trace_path(), ": Trace error: ",
+                trace->io_err_what() });
+            return EXIT_FAILURE;
         }
+    }
 
-        std::string frame;
+    if (handle_signals)
+    {
+        std::thread(_handle_signals, signals,
+            args.stats() ? counters.get() : nullptr, trace.get())
+            .detach();
+    }
+
+    // The protocol header is written while stdout still blocks, as a frame
+    // it could be dropped or replaced
+    _write(STDOUT_FILENO, plan->backend.header());
+
+    pcat::output output(STDOUT_FILENO);
 
-        // Set the period and print the cat
-        if (!sleeping)
+    if (!output.open())
+    {
+        _err({ "Output error: ", output.io_err_what() });
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<pcat::metrics> metrics;
+    std::thread metrics_thread;
+
+    if (export_metrics)
+    {
+        metrics = std::make_unique<pcat::metrics>(args.metrics_socket_path(),
+            args.metrics_file_path(), *counters);
+        if (!metrics->open())
         {
-            uint64_t period = get_period(low_rate, high_rate, load_displayed);
-            point += std::chrono::milliseconds(period);
-            period_prev = period;
-            frame = framer.get();
+            std::string path = args.metrics_socket_path();
+            _err({ path, path.empty() ? "" : ": ", "Metrics error: ",
+                metrics->io_err_what() });
+            return EXIT_FAILURE;
         }
-        else
+        metrics_thread =
+            std::thread(_export_metrics, std::cref(args), std::ref(*metrics));
+    }
+
+    // Recording is best effort, it never stops the cat
+    std::string history_path = pcat::recorder::default_path();
+    std::unique_ptr<pcat::recorder> recorder;
+
+    if (!history_path.empty())
+    {
+        recorder = std::make_unique<pcat::recorder>(history_path);
+        // Another instance records already, unless an IO error happened
+        if (!recorder->open())
         {
-            uint64_t period = 1000.0f / conf.sleeping_rate();
-            point += std::chrono::milliseconds(period);
-            frame = sleeping_framer.get();
+            if (recorder->io_err())
+            {
+                _err({ history_path, ": History error: ",
+                    recorder->io_err_what() });
+            }
+            recorder.reset();
         }
+    }
+
+    pcat::rate_poll rate_poll(plan->poll_period, args.stat_path(),
+        plan->history_samples(export_metrics), plan->spark_length,
+        pcat::clock::steady(), counters.get(), trace.get(), metrics.get(),
+        recorder.get());
 
-        // Format the output, if formatting is enabled
-        if (conf.format_enabled())
+    std::thread poll_thread([](pcat::rate_poll& rate_poll) { rate_poll.run(); },
+        std::ref(rate_poll));
+
+    pcat::pipeline pipeline(rate_poll, output, history_stats,
+        pcat::clock::steady(), counters.get(), trace.get());
+
+    // The built-in config never changes
+    pcat::conf_watch conf_watch(args.conf_path());
+    std::thread watch_thread;
+
+    if (!args.conf_path().empty())
+    {
+        if (conf_watch.open())
         {
-            uint8_t format_load =
-                static_cast<uint8_t>(std::lround(load * 100.0f));
-            std::cout << formatter.format(frame, format_load) << std::endl;
+            watch_thread = std::thread(_watch_conf, std::cref(args),
+                std::cref(conf), std::ref(conf_watch), std::ref(rate_poll),
+                std::ref(pipeline), std::cref(history_stats), export_metrics);
         }
         else
         {
-            std::cout << frame << std::endl;
+            _err({ args.conf_name(), ": Config watch error: ",
+                conf_watch.io_err_what() });
         }
+    }
 
-        std::this_thread::sleep_until(point);
+    switch (pipeline.run(std::move(plan)))
+    {
+    case pcat::pipeline::status::POLL_IO_ERR:
+        _err({ args.stat_path(), ": CPU polling error: ",
+            rate_poll.io_err_what() });
+        break;
+    case pcat::pipeline::status::POLL_FMT_ERR:
+        _err({ args.stat_path(), ": ", rate_poll.fmt_err_what() });
+        break;
+    case pcat::pipeline::status::OUTPUT_IO_ERR:
+        _err({ "Output error: ", output.io_err_what() });
+        break;
+    case pcat::pipeline::status::RELOAD:
+    case pcat::pipeline::status::STOPPED:
+        break;
     }
 
-    poll_thread.join();
+    if (watch_thread.joinable())
+    {
+        conf_watch.stop();
+        watch_thread.join();
+    }
 
-    return err ? EXIT_FAILURE : EXIT_SUCCESS;
-}
+    rate_poll.stop();
+    poll_thread.join();
 
-uint64_t get_period(uint64_t low_rate, uint64_t high_rate, float cpu_load)
-{
-    uint64_t diff = high_rate - low_rate;
+    if (metrics_thread.joinable())
+    {
+        metrics->stop();
+        metrics_thread.join();
+    }
 
-    uint64_t rate = low_rate + static_cast<uint64_t>(cpu_load * diff);
+    if (args.stats())
+    {
+        _print_counters(*counters);
+    }
 
-    uint64_t period = 1000 / rate;
+    if (trace != nullptr)
+    {
+        trace->close();
+    }
 
-    return period;
+    return EXIT_FAILURE;
 }
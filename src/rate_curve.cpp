@@ -0,0 +1,154 @@
+#include "rate_curve.h"
+
+#include <cmath>
+#include <charconv>
+#include <vector>
+
+#include "parse.h"
+
+// Steepness of the logarithmic and exponential curves
+static constexpr double CURVE_STEEPNESS = 9.0;
+
+struct _point
+{
+    double load;
+    double rate;
+};
+
+static bool _parse_number(const std::string& s, int64_t& value)
+{
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.length(), value);
+    return ec == std::errc() && ptr == s.data() + s.length();
+}
+
+static bool _parse_point(const std::string& s, _point& point)
+{
+    size_t pos = s.find(':');
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+
+    int64_t load = 0;
+    int64_t rate = 0;
+    if (!_parse_number(s.substr(0, pos), load) ||
+        !_parse_number(s.substr(pos + 1), rate))
+    {
+        return false;
+    }
+
+    if (load < 0 || load > 100 || rate < 1 || rate > 255)
+    {
+        return false;
+    }
+
+    point = { static_cast<double>(load) / 100.0, static_cast<double>(rate) };
+    return true;
+}
+
+namespace pcat
+{
+
+    const std::string rate_curve::LINEAR_CURVE = "linear";
+
+    const std::string rate_curve::LOG_CURVE = "log";
+
+    const std::string rate_curve::EXP_CURVE = "exp";
+
+    rate_curve::rate_curve() noexcept
+    {
+        m_periods.fill(std::chrono::seconds(1));
+    }
+
+    bool rate_curve::set(
+        const std::string& curve, uint8_t low_rate, uint8_t high_rate)
+    {
+        std::vector<_point> points;
+        bool named = curve == LINEAR_CURVE || curve == LOG_CURVE ||
+                     curve == EXP_CURVE;
+
+        if (!named)
+        {
+            for (const std::string& token : parse::words(curve))
+            {
+                _point point;
+                if (!_parse_point(token, point))
+                {
+                    m_fmt_err_what = "Point `" + token +
+                                     "` is not in `<load 0-100>:<rate 1-255>` "
+                                     "format.";
+                    return false;
+                }
+                if (!points.empty() && point.load <= points.back().load)
+                {
+                    m_fmt_err_what =
+                        "Point `" + token +
+                        "` does not follow the previous point load.";
+                    return false;
+                }
+                points.push_back(point);
+            }
+
+            if (points.empty())
+            {
+                m_fmt_err_what = "String \"" + curve +
+                                 "\" is neither a curve name nor a list of "
+                                 "points.";
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < RESOLUTION; i++)
+        {
+            double x = static_cast<double>(i) / (RESOLUTION - 1);
+            double rate = 0.0;
+
+            if (named)
+            {
+                double shape = x;
+                if (curve == LOG_CURVE)
+                {
+                    shape = std::log1p(CURVE_STEEPNESS * x) /
+                            std::log1p(CURVE_STEEPNESS);
+                }
+                else if (curve == EXP_CURVE)
+                {
+                    shape = std::expm1(std::log1p(CURVE_STEEPNESS) * x) /
+                            CURVE_STEEPNESS;
+                }
+                rate = low_rate + (high_rate - low_rate) * shape;
+            }
+            else if (x <= points.front().load)
+            {
+                rate = points.front().rate;
+            }
+            else if (x >= points.back().load)
+            {
+                rate = points.back().rate;
+            }
+            else
+            {
+                size_t j = 1;
+                while (points[j].load < x)
+                {
+                    j++;
+                }
+                const _point& a = points[j - 1];
+                const _point& b = points[j];
+                rate = a.rate + (b.rate - a.rate) * (x - a.load) /
+                                    (b.load - a.load);
+            }
+
+            m_periods[i] = std::chrono::nanoseconds(
+                static_cast<int64_t>(std::llround(1e9 / rate)));
+        }
+
+        return true;
+    }
+
+    const char* rate_curve::fmt_err_what() const noexcept
+    {
+        return m_fmt_err_what.c_str();
+    }
+
+}
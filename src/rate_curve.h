@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <array>
+
+#include "formatter.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Maps CPU load to animation frame period
+     */
+    class rate_curve
+    {
+    public:
+        static const std::string LINEAR_CURVE;
+
+        static const std::string LOG_CURVE;
+
+        static const std::string EXP_CURVE;
+
+        static constexpr size_t RESOLUTION = 1024;
+
+        /**
+         * @brief Constructs an instance with all periods equal to one second
+         */
+        rate_curve() noexcept;
+
+        /**
+         * @brief Precomputes periods for the curve,
+         * Example points: "0:2 50:10 100:30"
+         * @param curve Curve name or points of CPU load percent and rate
+         * @param low_rate Rate at 0% load for named curves
+         * @param high_rate Rate at 100% load for named curves
+         * @return true - on success, false - otherwise
+         */
+        bool set(const std::string& curve, uint8_t low_rate, uint8_t high_rate);
+
+        /**
+         * @brief Tells why the last set failed
+         * @return message string, if set failed, empty string - otherwise
+         */
+        const char* fmt_err_what() const noexcept;
+
+        /**
+         * @brief Tells the frame period for CPU load
+         * @param load Value in range [0-1]
+         */
+        std::chrono::nanoseconds period(float load) const noexcept
+        {
+            float pos = formatter::load_clamp(load) * (RESOLUTION - 1) + 0.5f;
+            return m_periods[static_cast<size_t>(pos)];
+        }
+
+    private:
+        std::array<std::chrono::nanoseconds, RESOLUTION> m_periods;
+        std::string m_fmt_err_what;
+    };
+
+}
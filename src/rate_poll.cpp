@@ -1,26 +1,44 @@
 #include "rate_poll.h"
 
-#include <thread>
-
 #include "cpu.h"
+#include "formatter.h"
+#include "alloc_audit.h"
 
 namespace pcat
 {
 
-    rate_poll::rate_poll(uint64_t period, const std::string& stat_path) noexcept
-        :
+    rate_poll::rate_poll(uint64_t period, const std::string& stat_path,
+        uint64_t history_capacity, uint64_t spark_length, clock& clock,
+        counters* counters, trace* trace, metrics* metrics,
+        recorder* recorder) noexcept :
         m_cpu(stat_path),
+        m_clock(clock),
+        m_counters(counters),
+        m_trace(trace),
+        m_metrics(metrics),
+        m_metrics_stats(),
+        m_recorder(recorder),
         m_period(period),
         m_done(false),
         m_io_err(false),
         m_fmt_err(false),
-        m_cpu_load(0.0f)
+        m_cpu_load(0.0f),
+        m_samples(0),
+        m_history(history_capacity, spark_length),
+        m_history_capacity(history_capacity),
+        m_spark_length(spark_length),
+        m_stopped(false),
+        m_interrupted(false)
     {
     }
 
     void rate_poll::run() noexcept
     {
-        using namespace std::chrono;
+        alloc_audit::scope scope(alloc_audit::PHASE_POLL);
+
+        trace::ring* ring =
+            m_trace != nullptr ? m_trace->thread("poll") : nullptr;
+        bool first_poll = true;
 
         while (true)
         {
@@ -32,36 +50,71 @@ namespace pcat
             }
             m_done_mut.unlock();
 
-            auto point = steady_clock::now();
-            point += m_period;
-
-            float cpu_load = 0.0f;
+            m_cpu_load_mut.lock();
+            auto start = m_clock.now();
+            auto point = start + m_period;
+            m_cpu_load_mut.unlock();
 
-            try
+            std::optional<float> polled;
             {
-                cpu_load = m_cpu.poll();
+                trace::span span(ring, "poll");
+                polled = m_cpu.poll();
             }
-            catch (cpu::io_err& e)
+            if (m_cpu.io_err())
             {
                 std::lock_guard guard(m_io_err_mut);
                 m_io_err = true;
-                m_io_err_what = e.what();
+                m_io_err_what = m_cpu.io_err_what();
                 break;
             }
-            catch (cpu::fmt_err& e)
+            if (m_cpu.fmt_err())
             {
                 std::lock_guard guard(m_fmt_err_mut);
                 m_fmt_err = true;
-                m_fmt_err_what = e.what();
+                m_fmt_err_what = m_cpu.fmt_err_what();
                 break;
             }
+            float cpu_load = *polled;
 
-            m_cpu_load_mut.lock();
-            m_cpu_load = cpu_load;
-            m_cpu_load_mut.unlock();
+            if (m_counters != nullptr)
+            {
+                m_counters->add_poll(m_clock.now() - start,
+                    m_cpu.read_bytes(), m_cpu.syscalls());
+            }
 
-            std::this_thread::sleep_until(point);
+            sample(cpu_load);
+
+            if (m_metrics != nullptr)
+            {
+                m_cpu_load_mut.lock();
+                m_history.get(m_metrics_stats);
+                m_cpu_load_mut.unlock();
+                m_metrics->update(cpu_load, m_metrics_stats);
+            }
+
+            // Samples are stamped with the wall clock to be found by date.
+            // The first poll averages the load since boot, not around now
+            if (m_recorder != nullptr && !first_poll)
+            {
+                m_recorder->append(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count(),
+                    cpu_load);
+            }
+            first_poll = false;
+
+            if (m_counters != nullptr)
+            {
+                m_counters->sleeps.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_clock.sleep_until(point);
         }
+
+        m_cpu_load_mut.lock();
+        m_stopped = true;
+        m_cpu_load_mut.unlock();
+        m_cpu_load_cv.notify_all();
     }
 
     void rate_poll::stop() noexcept
@@ -70,6 +123,38 @@ namespace pcat
         m_done = true;
     }
 
+    void rate_poll::sample(float cpu_load) noexcept
+    {
+        m_cpu_load_mut.lock();
+        m_cpu_load = cpu_load;
+        m_samples++;
+        m_history.push(formatter::percent(cpu_load));
+        m_cpu_load_mut.unlock();
+        m_cpu_load_cv.notify_all();
+    }
+
+    void rate_poll::configure(
+        uint64_t period, uint64_t history_capacity, uint64_t spark_length)
+    {
+        std::lock_guard guard(m_cpu_load_mut);
+        m_period = std::chrono::milliseconds(period);
+        if (history_capacity != m_history_capacity ||
+            spark_length != m_spark_length)
+        {
+            m_history = history(history_capacity, spark_length);
+            m_history_capacity = history_capacity;
+            m_spark_length = spark_length;
+        }
+    }
+
+    void rate_poll::interrupt() noexcept
+    {
+        m_cpu_load_mut.lock();
+        m_interrupted = true;
+        m_cpu_load_mut.unlock();
+        m_cpu_load_cv.notify_all();
+    }
+
     bool rate_poll::io_err() noexcept
     {
         std::lock_guard guard(m_io_err_mut);
@@ -100,4 +185,42 @@ namespace pcat
         return m_cpu_load;
     }
 
+    void rate_poll::wait_above(float threshold) noexcept
+    {
+        std::unique_lock lock(m_cpu_load_mut);
+        while (!(m_cpu_load > threshold) && !m_stopped && !m_interrupted)
+        {
+            if (!m_clock.wait(lock, m_cpu_load_cv))
+            {
+                break;
+            }
+        }
+        m_interrupted = false;
+    }
+
+    uint64_t rate_poll::wait_sample(uint64_t seen) noexcept
+    {
+        std::unique_lock lock(m_cpu_load_mut);
+        while (m_samples <= seen && !m_stopped && !m_interrupted)
+        {
+            if (!m_clock.wait(lock, m_cpu_load_cv))
+            {
+                break;
+            }
+        }
+        m_interrupted = false;
+        return m_samples;
+    }
+
+    uint64_t rate_poll::get_history(
+        history::stats& stats, uint64_t seen) noexcept
+    {
+        std::lock_guard guard(m_cpu_load_mut);
+        if (m_samples > seen)
+        {
+            m_history.get(stats);
+        }
+        return m_samples;
+    }
+
 }
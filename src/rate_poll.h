@@ -4,8 +4,15 @@
 #include <chrono>
 #include <cstdint>
 #include <mutex>
+#include <condition_variable>
 
 #include "cpu.h"
+#include "history.h"
+#include "counters.h"
+#include "trace.h"
+#include "clock.h"
+#include "metrics.h"
+#include "recorder.h"
 
 namespace pcat
 {
@@ -18,8 +25,21 @@ namespace pcat
     public:
         /**
          * @param period Period of polling
+         * @param stat_path Stat file path
+         * @param history_capacity Number of samples kept in history
+         * @param spark_length Number of samples shown by the sparkline
+         * @param clock Clock to poll and wait on
+         * @param counters Runtime counters, nullptr to disable counting
+         * @param trace Trace to record polls into, nullptr to disable tracing
+         * @param metrics Metrics to render after every poll, nullptr to
+         * disable the export
+         * @param recorder Recorder to append every poll to, nullptr to
+         * disable recording
          */
-        rate_poll(uint64_t period, const std::string& stat_path) noexcept;
+        rate_poll(uint64_t period, const std::string& stat_path,
+            uint64_t history_capacity, uint64_t spark_length, clock& clock,
+            counters* counters, trace* trace, metrics* metrics,
+            recorder* recorder) noexcept;
 
         /**
          * @brief CPU polling routine (should be run in separate thread)
@@ -31,6 +51,29 @@ namespace pcat
          */
         void stop() noexcept;
 
+        /**
+         * @brief Records a CPU load taken elsewhere as the latest sample,
+         * used instead of run() to drive the poll from a simulation
+         * @param cpu_load Value in range [0-1]
+         */
+        void sample(float cpu_load) noexcept;
+
+        /**
+         * @brief Changes polling parameters without losing the CPU state,
+         * load history is kept unless its size changes
+         * @param period Polling period in milliseconds
+         * @param history_capacity Number of samples kept in load history
+         * @param spark_length Number of samples shown by the spark key
+         */
+        void configure(uint64_t period, uint64_t history_capacity,
+            uint64_t spark_length);
+
+        /**
+         * @brief Makes a pending or the next wait_above() or wait_sample()
+         * call return early
+         */
+        void interrupt() noexcept;
+
         /**
          * @brief Tells if an IO error has happened during CPU polling
          * @return true - on error, false - otherwise
@@ -61,8 +104,37 @@ namespace pcat
          */
         float poll() noexcept;
 
+        /**
+         * @brief Blocks until the CPU load exceeds the threshold, polling
+         * stops or the wait is interrupted
+         * @param threshold Value in range [0-1]
+         */
+        void wait_above(float threshold) noexcept;
+
+        /**
+         * @brief Blocks until a sample newer than seen is taken, polling
+         * stops or the wait is interrupted
+         * @param seen Number of the last sample seen, 0 if none
+         * @return Number of the latest sample
+         */
+        uint64_t wait_sample(uint64_t seen) noexcept;
+
+        /**
+         * @brief Copies load history statistics if a newer sample was taken
+         * @param stats Destination
+         * @param seen Number of the sample stats were copied at, 0 if none
+         * @return Number of the latest sample
+         */
+        uint64_t get_history(history::stats& stats, uint64_t seen) noexcept;
+
     private:
         cpu m_cpu;
+        clock& m_clock;
+        counters* m_counters;
+        trace* m_trace;
+        metrics* m_metrics;
+        history::stats m_metrics_stats;
+        recorder* m_recorder;
         std::chrono::milliseconds m_period;
         bool m_done;
         bool m_io_err;
@@ -70,10 +142,17 @@ namespace pcat
         bool m_fmt_err;
         std::string m_fmt_err_what;
         float m_cpu_load;
+        uint64_t m_samples;
+        history m_history;
+        uint64_t m_history_capacity;
+        uint64_t m_spark_length;
+        bool m_stopped;
+        bool m_interrupted;
         std::mutex m_done_mut;
         std::mutex m_io_err_mut;
         std::mutex m_fmt_err_mut;
         std::mutex m_cpu_load_mut;
+        std::condition_variable m_cpu_load_cv;
     };
 
 }
@@ -0,0 +1,384 @@
+#include "recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "formatter.h"
+
+static constexpr char MAGIC[8] = { 'P', 'C', 'A', 'T', 'H', 'I', 'S', 'T' };
+
+static constexpr uint32_t VERSION = 1;
+
+/**
+ * @brief Longest LEB128 encoding of a 64-bit value
+ */
+static constexpr size_t VARINT_MAX = 10;
+
+struct _file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t reserved[11];
+};
+
+/**
+ * @brief Starts every block, the first sample of the block is stored here
+ * and the following ones as deltas after the header
+ */
+struct _block_header
+{
+    // Sequence number of the block, 0 - unused or being replaced
+    uint64_t seq;
+    int64_t time;
+    // Bytes of deltas following the header
+    uint32_t used;
+    uint16_t load;
+    uint16_t reserved;
+};
+
+static constexpr size_t FILE_HEADER_SIZE = 64;
+
+static_assert(sizeof(_file_header) == FILE_HEADER_SIZE);
+
+static_assert(sizeof(_block_header) % alignof(uint64_t) == 0);
+
+static constexpr size_t BLOCK_DATA_SIZE =
+    pcat::recorder::BLOCK_SIZE - sizeof(_block_header);
+
+static constexpr size_t FILE_SIZE =
+    FILE_HEADER_SIZE + pcat::recorder::BLOCK_SIZE * pcat::recorder::BLOCK_COUNT;
+
+static _block_header* _block(unsigned char* map, size_t index) noexcept
+{
+    return reinterpret_cast<_block_header*>(
+        map + FILE_HEADER_SIZE + index * pcat::recorder::BLOCK_SIZE);
+}
+
+static size_t _put_varint(unsigned char* out, int64_t value) noexcept
+{
+    // Zigzag, so small negative deltas stay short
+    uint64_t v = (static_cast<uint64_t>(value) << 1) ^
+                 static_cast<uint64_t>(value >> 63);
+
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        out[n++] = static_cast<unsigned char>(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(v);
+    return n;
+}
+
+static bool _get_varint(
+    const unsigned char* in, size_t size, size_t& pos, int64_t& value) noexcept
+{
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64 && pos < size; shift += 7)
+    {
+        unsigned char byte = in[pos++];
+        v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            value = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _valid_header(const _file_header& header) noexcept
+{
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           header.version == VERSION &&
+           header.block_size == pcat::recorder::BLOCK_SIZE &&
+           header.block_count == pcat::recorder::BLOCK_COUNT;
+}
+
+namespace pcat
+{
+
+    const std::string recorder::FILE_NAME = "polycat-history";
+
+    std::string recorder::default_path()
+    {
+        const char* dir = std::getenv("XDG_RUNTIME_DIR");
+
+        if (dir == nullptr || *dir == '\0')
+        {
+            return "";
+        }
+
+        std::string path = dir;
+        if (path.back() != '/')
+        {
+            path += "/";
+        }
+        return path + FILE_NAME;
+    }
+
+    recorder::recorder(const std::string& path) noexcept :
+        m_path(path),
+        m_fd(-1),
+        m_errno(0),
+        m_map(nullptr),
+        m_seq(0),
+        m_block(BLOCK_COUNT - 1),
+        m_used(BLOCK_DATA_SIZE),
+        m_last(),
+        m_unsynced(0)
+    {
+    }
+
+    recorder::~recorder() noexcept
+    {
+        if (m_map != nullptr)
+        {
+            msync(m_map, FILE_SIZE, MS_ASYNC);
+            munmap(m_map, FILE_SIZE);
+        }
+        if (m_fd != -1)
+        {
+            close(m_fd);
+        }
+    }
+
+    bool recorder::open() noexcept
+    {
+        m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (m_fd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        // Another instance keeps the lock until it exits
+        if (flock(m_fd, LOCK_EX | LOCK_NB) == -1)
+        {
+            if (errno != EWOULDBLOCK)
+            {
+                m_errno = errno;
+            }
+            return false;
+        }
+
+        struct stat st;
+        _file_header header {};
+        bool valid = fstat(m_fd, &st) == 0 && st.st_size == FILE_SIZE &&
+                     pread(m_fd, &header, sizeof(header), 0) ==
+                         sizeof(header) &&
+                     _valid_header(header);
+
+        // Truncating first zeroes every block of a replaced file
+        if (!valid && (ftruncate(m_fd, 0) == -1 ||
+                          ftruncate(m_fd, FILE_SIZE) == -1))
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        void* map = mmap(
+            nullptr, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (map == MAP_FAILED)
+        {
+            m_errno = errno;
+            return false;
+        }
+        m_map = static_cast<unsigned char*>(map);
+
+        if (!valid)
+        {
+            // The magic goes last, a file torn before it is replaced again
+            _file_header* mapped = reinterpret_cast<_file_header*>(m_map);
+            mapped->version = VERSION;
+            mapped->block_size = BLOCK_SIZE;
+            mapped->block_count = BLOCK_COUNT;
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(mapped->magic, MAGIC, sizeof(MAGIC));
+        }
+
+        // Continues after the newest block, the first append starts one.
+        // Headers are read with pread(2), through the mapping every page of
+        // the ring would become resident
+        for (size_t i = 0; valid && i < BLOCK_COUNT; i++)
+        {
+            uint64_t seq = 0;
+            off_t offset = FILE_HEADER_SIZE + i * BLOCK_SIZE;
+            ssize_t n = pread(m_fd, &seq, sizeof(seq), offset);
+            if (n != sizeof(seq))
+            {
+                m_errno = n == -1 ? errno : EIO;
+                return false;
+            }
+            if (seq > m_seq)
+            {
+                m_seq = seq;
+                m_block = i;
+            }
+        }
+
+        return true;
+    }
+
+    bool recorder::io_err() const noexcept { return m_errno != 0; }
+
+    const char* recorder::io_err_what() const noexcept
+    {
+        return m_errno != 0 ? std::strerror(m_errno) : "";
+    }
+
+    void recorder::append(int64_t time, float load) noexcept
+    {
+        if (m_map == nullptr)
+        {
+            return;
+        }
+
+        sample curr = { time,
+            static_cast<uint16_t>(
+                std::lround(formatter::load_clamp(load) * 1000.0f)) };
+
+        unsigned char buf[2 * VARINT_MAX];
+        size_t n = _put_varint(buf, curr.time - m_last.time);
+        n += _put_varint(buf + n, curr.load - m_last.load);
+
+        if (m_used + n > BLOCK_DATA_SIZE)
+        {
+            start_block(curr);
+        }
+        else
+        {
+            // Deltas are written before they are published
+            _block_header* block = _block(m_map, m_block);
+            std::memcpy(
+                m_map + FILE_HEADER_SIZE + m_block * BLOCK_SIZE +
+                    sizeof(_block_header) + m_used,
+                buf, n);
+            m_used += n;
+            std::atomic_ref(block->used).store(
+                static_cast<uint32_t>(m_used), std::memory_order_release);
+        }
+        m_last = curr;
+
+        if (++m_unsynced >= SYNC_SAMPLES)
+        {
+            sync();
+        }
+    }
+
+    std::optional<std::vector<recorder::sample>> recorder::read(
+        const std::string& path, int& err) noexcept
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            err = errno;
+            return std::nullopt;
+        }
+
+        std::vector<unsigned char> buf(FILE_SIZE);
+        size_t size = 0;
+        while (size < FILE_SIZE)
+        {
+            ssize_t n = ::read(fd, buf.data() + size, FILE_SIZE - size);
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n == -1)
+            {
+                err = errno;
+                close(fd);
+                return std::nullopt;
+            }
+            if (n == 0)
+            {
+                break;
+            }
+            size += n;
+        }
+        close(fd);
+
+        _file_header header;
+        std::memcpy(&header, buf.data(), sizeof(header));
+        if (size != FILE_SIZE || !_valid_header(header))
+        {
+            err = 0;
+            return std::nullopt;
+        }
+
+        std::vector<std::pair<uint64_t, size_t>> blocks;
+        for (size_t i = 0; i < BLOCK_COUNT; i++)
+        {
+            uint64_t seq = _block(buf.data(), i)->seq;
+            if (seq != 0)
+            {
+                blocks.emplace_back(seq, i);
+            }
+        }
+        std::sort(blocks.begin(), blocks.end());
+
+        std::vector<sample> samples;
+        for (const auto& [seq, i] : blocks)
+        {
+            const _block_header* block = _block(buf.data(), i);
+            const unsigned char* data =
+                reinterpret_cast<const unsigned char*>(block + 1);
+            size_t used = std::min<size_t>(block->used, BLOCK_DATA_SIZE);
+
+            sample curr = { block->time, block->load };
+            samples.push_back(curr);
+
+            size_t pos = 0;
+            int64_t time_delta = 0;
+            int64_t load_delta = 0;
+            while (_get_varint(data, used, pos, time_delta) &&
+                   _get_varint(data, used, pos, load_delta))
+            {
+                curr.time += time_delta;
+                curr.load = static_cast<uint16_t>(curr.load + load_delta);
+                samples.push_back(curr);
+            }
+        }
+
+        return samples;
+    }
+
+    void recorder::start_block(const sample& first) noexcept
+    {
+        m_block = (m_block + 1) % BLOCK_COUNT;
+        m_seq++;
+
+        // Readers skip the block while it is being replaced
+        _block_header* block = _block(m_map, m_block);
+        std::atomic_ref(block->seq).store(0, std::memory_order_release);
+        block->time = first.time;
+        block->load = first.load;
+        std::atomic_ref(block->used).store(0, std::memory_order_relaxed);
+        std::atomic_ref(block->seq).store(m_seq, std::memory_order_release);
+        m_used = 0;
+
+        sync();
+    }
+
+    void recorder::sync() noexcept
+    {
+        msync(m_map, FILE_SIZE, MS_ASYNC);
+        m_unsynced = 0;
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+
+namespace pcat
+{
+
+    /**
+     * @brief Records CPU load samples into a fixed-size memory-mapped ring
+     * file, so recent load history survives polycat and costs no syscalls
+     * per sample
+     *
+     * The file is a header followed by blocks used as a ring. A block holds
+     * an absolute first sample followed by varint-encoded deltas of the
+     * following ones. Block headers are published after the sample bytes
+     * they cover, so a crash leaves every block decodable.
+     */
+    class recorder
+    {
+    public:
+        static constexpr size_t BLOCK_SIZE = 4096;
+
+        static constexpr size_t BLOCK_COUNT = 64;
+
+        /**
+         * @brief Number of samples between msync(2) calls
+         */
+        static constexpr uint64_t SYNC_SAMPLES = 64;
+
+        static const std::string FILE_NAME;
+
+        /**
+         * @brief Recorded CPU load
+         */
+        struct sample
+        {
+            // Milliseconds since the Unix epoch
+            int64_t time;
+            // CPU load in range [0-1000]
+            uint16_t load;
+        };
+
+        /**
+         * @brief Tells the default history file location
+         * @return `$XDG_RUNTIME_DIR/polycat-history`, empty string if
+         * XDG_RUNTIME_DIR is not set
+         */
+        static std::string default_path();
+
+        /**
+         * @brief Constructs an instance for specified file
+         * @param path History file path
+         */
+        recorder(const std::string& path) noexcept;
+
+        ~recorder() noexcept;
+
+        recorder(const recorder&) = delete;
+
+        recorder& operator=(const recorder&) = delete;
+
+        /**
+         * @brief Maps the file, creating it or replacing an incompatible one,
+         * and starts a new block after the newest one
+         * @return true - on success, false - on IO errors or if another
+         * instance is recording into the file
+         */
+        bool open() noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened during open
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
+
+        /**
+         * @brief Appends a sample
+         * @param time Milliseconds since the Unix epoch
+         * @param load CPU load in range [0-1]
+         */
+        void append(int64_t time, float load) noexcept;
+
+        /**
+         * @brief Decodes every sample of a history file, oldest first
+         * @param path History file path
+         * @param err Set to errno on IO errors, to 0 on malformed files
+         * @return Samples, std::nullopt on errors
+         */
+        static std::optional<std::vector<sample>> read(
+            const std::string& path, int& err) noexcept;
+
+    private:
+        std::string m_path;
+        int m_fd;
+        int m_errno;
+        unsigned char* m_map;
+        uint64_t m_seq;
+        size_t m_block;
+        size_t m_used;
+        sample m_last;
+        uint64_t m_unsynced;
+
+        /**
+         * @brief Starts the next block of the ring with the sample
+         */
+        void start_block(const sample& first) noexcept;
+
+        /**
+         * @brief Schedules writeback of the current block
+         */
+        void sync() noexcept;
+    };
+
+}
@@ -0,0 +1,47 @@
+#include "render_table.h"
+
+namespace pcat
+{
+
+    render_table::render_table() noexcept :
+        m_arena(),
+        m_index(),
+        m_frame_step(1),
+        m_load_step(0)
+    {
+    }
+
+    render_table::render_table(const framer& framer,
+        const formatter& formatter, const backend& backend, bool sleeping) :
+        m_arena(),
+        m_index(),
+        m_frame_step(1),
+        m_load_step(0)
+    {
+        if ((formatter.deps() | backend.deps()) & formatter::DEP_LOAD)
+        {
+            m_frame_step = formatter::LOAD_VALUES;
+            m_load_step = 1;
+        }
+
+        m_index.reserve(framer.count() * m_frame_step);
+        std::string text;
+        for (uint64_t i = 0; i < framer.count(); i++)
+        {
+            for (uint64_t load = 0; load < m_frame_step; load++)
+            {
+                uint8_t l = static_cast<uint8_t>(load);
+
+                text.clear();
+                formatter.format(text, { framer.at(i), l });
+
+                size_t offset = m_arena.size();
+                backend.serialize(m_arena, { text, l, sleeping });
+                m_index.push_back({ static_cast<uint32_t>(offset),
+                    static_cast<uint32_t>(m_arena.size() - offset) });
+            }
+        }
+        m_arena.shrink_to_fit();
+    }
+
+}
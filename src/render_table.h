@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <vector>
+
+#include "framer.h"
+#include "formatter.h"
+#include "backend.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Holds output lines rendered ahead of time for every frame and
+     * CPU load value
+     */
+    class render_table
+    {
+    public:
+        /**
+         * @brief Constructs an empty table
+         */
+        render_table() noexcept;
+
+        /**
+         * @brief Renders formatted and serialized frames for every CPU load
+         * value, load is not taken into account if the line does not
+         * depend on it
+         * @param framer Frames source
+         * @param formatter Formatter with format set
+         * @param backend Output backend
+         * @param sleeping Whether the frames are sleeping frames
+         */
+        render_table(const framer& framer, const formatter& formatter,
+            const backend& backend, bool sleeping);
+
+        /**
+         * @brief Tells the rendered line
+         * @param frame Frame index
+         * @param load CPU load in range [0-100]
+         * @return Line stored in the table
+         */
+        std::string_view get(uint64_t frame, uint8_t load) const noexcept
+        {
+            const entry& e = m_index[frame * m_frame_step + load * m_load_step];
+            return std::string_view(m_arena.data() + e.offset, e.length);
+        }
+
+    private:
+        struct entry
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        std::string m_arena;
+        std::vector<entry> m_index;
+        uint64_t m_frame_step;
+        uint64_t m_load_step;
+    };
+
+}
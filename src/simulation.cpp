@@ -0,0 +1,212 @@
+#include "simulation.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "rate_poll.h"
+#include "output.h"
+#include "counters.h"
+
+/**
+ * @brief Formats a fixed-point value
+ * @param value Value scaled by 10^decimals
+ * @param decimals Number of decimal digits
+ */
+static std::string _fixed(uint64_t value, int decimals)
+{
+    uint64_t scale = 1;
+    for (int i = 0; i < decimals; i++)
+    {
+        scale *= 10;
+    }
+
+    std::string fraction = std::to_string(value % scale);
+    fraction.insert(0, static_cast<size_t>(decimals) - fraction.size(), '0');
+    return std::to_string(value / scale) + "." + fraction;
+}
+
+static uint64_t _percent(float load)
+{
+    return static_cast<uint64_t>(load * 100.0f + 0.5f);
+}
+
+namespace pcat
+{
+
+    simulation::simulation(
+        const load_profile& profile, std::string& out) noexcept :
+        m_profile(profile),
+        m_out(out),
+        m_start(),
+        m_stats(),
+        m_frames(0),
+        m_written(0),
+        m_suppressed(0),
+        m_last_frame()
+    {
+    }
+
+    pipeline::status simulation::run(
+        std::unique_ptr<const plan> plan, history::stats& stats)
+    {
+        using namespace std::chrono;
+
+        auto real_start = steady_clock::now();
+
+        int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        output output(fd);
+        if (fd < 0 || !output.open())
+        {
+            return pipeline::status::OUTPUT_IO_ERR;
+        }
+
+        counters counters;
+        virtual_clock sim_clock(m_start);
+        rate_poll rate_poll(plan->poll_period, "",
+            plan->history_samples(false), plan->spark_length, sim_clock,
+            nullptr, nullptr, nullptr, nullptr);
+        pipeline pipeline(
+            rate_poll, output, stats, sim_clock, &counters, nullptr);
+
+        sim_clock.observe(
+            [&](clock::time_point now)
+            {
+                observe(now, counters.frames.load(std::memory_order_relaxed),
+                    output.written(), output.suppressed());
+            });
+
+        m_stats.assign(m_profile.segments().size() + 1,
+            { 0, 0, {}, {}, 0.0f, 0, 0, 0 });
+        m_frames = 0;
+        m_written = 0;
+        m_suppressed = 0;
+        m_last_frame = m_start;
+
+        // Polls every period like the poll thread, the first sample is taken
+        // before the first frame. A sample averages the load over the period
+        // before it and is filed under the middle of that window, so it
+        // counts towards the segment the load came from.
+        milliseconds period(plan->poll_period);
+        auto poll = [&](clock::time_point now)
+        {
+            if (now - m_start >= m_profile.length())
+            {
+                pipeline.stop();
+                return clock::time_point::max();
+            }
+
+            nanoseconds to = now - m_start;
+            nanoseconds from =
+                std::max<nanoseconds>(to - period, nanoseconds(0));
+            float load = m_profile.average(from, to);
+            sample(m_start + from + (to - from) / 2, load);
+            rate_poll.sample(load);
+            return now + period;
+        };
+        sim_clock.schedule(poll(m_start), poll);
+
+        pipeline::status status = pipeline.run(std::move(plan));
+        close(fd);
+        report();
+
+        if (status == pipeline::status::STOPPED)
+        {
+            auto real = steady_clock::now() - real_start;
+            m_out += "total: " + _fixed(m_profile.length().count(), 3) +
+                     "s simulated in " +
+                     std::to_string(
+                         duration_cast<milliseconds>(real).count()) +
+                     "ms, frames " + std::to_string(m_frames) +
+                     " written " + std::to_string(output.written()) +
+                     " suppressed " + std::to_string(output.suppressed()) +
+                     " dropped " + std::to_string(output.dropped()) + "\n";
+        }
+
+        return status;
+    }
+
+    simulation::segment_stats& simulation::stats_at(
+        clock::time_point time) noexcept
+    {
+        return m_stats[m_profile.index(time - m_start)];
+    }
+
+    void simulation::report()
+    {
+        using namespace std::chrono;
+
+        uint64_t end = 0;
+        for (size_t i = 0; i < m_profile.segments().size(); i++)
+        {
+            const load_profile::segment& seg = m_profile.segments()[i];
+            const segment_stats& stats = m_stats[i];
+            uint64_t start = end;
+            end += seg.duration.count();
+            uint64_t load_avg = stats.samples != 0
+                                  ? _percent(stats.load_sum / stats.samples)
+                                  : 0;
+
+            std::string row = _fixed(start, 3) + "s-" + _fixed(end, 3) +
+                              "s load " + std::to_string(_percent(seg.from)) +
+                              "%-" + std::to_string(_percent(seg.to)) +
+                              "% avg " + std::to_string(load_avg) + "%: ";
+            row += "frames " + std::to_string(stats.frames) + " fps " +
+                   _fixed(stats.frames * 10'000 / seg.duration.count(), 1);
+            if (stats.intervals != 0)
+            {
+                // Tenths of a millisecond
+                uint64_t min_interval =
+                    duration_cast<microseconds>(stats.min_interval).count() /
+                    100;
+                uint64_t max_interval =
+                    duration_cast<microseconds>(stats.max_interval).count() /
+                    100;
+                row += " interval " + _fixed(min_interval, 1) + "-" +
+                       _fixed(max_interval, 1) + "ms";
+            }
+            row += " written " + std::to_string(stats.written) +
+                   " suppressed " + std::to_string(stats.suppressed) + "\n";
+            m_out += row;
+        }
+    }
+
+    void simulation::observe(clock::time_point now, uint64_t frames,
+        uint64_t written, uint64_t suppressed)
+    {
+        segment_stats& stats = stats_at(now);
+
+        if (frames > m_frames)
+        {
+            // The first frame has no interval
+            if (m_frames != 0)
+            {
+                auto interval = now - m_last_frame;
+                if (stats.intervals == 0 || interval < stats.min_interval)
+                {
+                    stats.min_interval = interval;
+                }
+                if (stats.intervals == 0 || interval > stats.max_interval)
+                {
+                    stats.max_interval = interval;
+                }
+                stats.intervals++;
+            }
+            stats.frames += frames - m_frames;
+            m_frames = frames;
+            m_last_frame = now;
+        }
+
+        stats.written += written - m_written;
+        stats.suppressed += suppressed - m_suppressed;
+        m_written = written;
+        m_suppressed = suppressed;
+    }
+
+    void simulation::sample(clock::time_point time, float load)
+    {
+        segment_stats& stats = stats_at(time);
+        stats.load_sum += load;
+        stats.samples++;
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "plan.h"
+#include "pipeline.h"
+#include "history.h"
+#include "load_profile.h"
+#include "clock.h"
+
+namespace pcat
+{
+
+    /**
+     * @brief Runs the render loop on virtual time against a load profile
+     * and reports frame timing and output statistics per segment
+     */
+    class simulation
+    {
+    public:
+        /**
+         * @brief Constructs an instance
+         * @param profile Load profile
+         * @param out String to append the report to
+         */
+        simulation(const load_profile& profile, std::string& out) noexcept;
+
+        /**
+         * @brief Runs the whole profile, frames are written to /dev/null
+         * @param plan Resolved config
+         * @param stats History statistics the plan keys display
+         * @return pipeline::status::STOPPED at the end of the profile, reason
+         * the loop stopped otherwise
+         */
+        pipeline::status run(
+            std::unique_ptr<const plan> plan, history::stats& stats);
+
+    private:
+        /**
+         * @brief Frames and load of a segment
+         */
+        struct segment_stats
+        {
+            uint64_t frames;
+            uint64_t intervals;
+            clock::time_point::duration min_interval;
+            clock::time_point::duration max_interval;
+            float load_sum;
+            uint64_t samples;
+            uint64_t written;
+            uint64_t suppressed;
+        };
+
+        const load_profile& m_profile;
+        std::string& m_out;
+        clock::time_point m_start;
+        // One entry per segment and one for whatever happens past the end
+        std::vector<segment_stats> m_stats;
+        uint64_t m_frames;
+        uint64_t m_written;
+        uint64_t m_suppressed;
+        clock::time_point m_last_frame;
+
+        /**
+         * @brief Returns statistics of the segment the time falls into
+         * @param time Time
+         */
+        segment_stats& stats_at(clock::time_point time) noexcept;
+
+        /**
+         * @brief Reports every segment
+         */
+        void report();
+
+        /**
+         * @brief Records frames emitted since the previous call, they are
+         * timed at the call
+         * @param now Current time
+         * @param frames Number of frames emitted so far
+         * @param written Number of lines written so far
+         * @param suppressed Number of lines suppressed so far
+         */
+        void observe(clock::time_point now, uint64_t frames, uint64_t written,
+            uint64_t suppressed);
+
+        /**
+         * @brief Records a load sample
+         * @param time Middle of the window the load is averaged over
+         * @param load Value in range [0-1]
+         */
+        void sample(clock::time_point time, float load);
+    };
+
+}
@@ -1,38 +1,98 @@
 #include "smoother.h"
 
 #include <algorithm>
+#include <cmath>
+
+// Time constants per period, chosen so that every kernel covers about 98% of
+// a step in one period
+static constexpr float EMA_RATE = 4.0f;
+
+static constexpr float SPRING_RATE = 6.0f;
 
 namespace pcat
 {
 
-    smoother::smoother(uint64_t period) noexcept :
-        m_period(period),
-        m_target(0.0f),
-        m_prev(0.0f)
+    const std::string smoother::LINEAR_KERNEL = "linear";
+
+    const std::string smoother::EMA_KERNEL = "ema";
+
+    const std::string smoother::SPRING_KERNEL = "spring";
+
+    smoother::smoother(
+        uint64_t period, const std::string& kernel, float value) noexcept :
+        m_kernel(kernel::LINEAR),
+        m_rate(1.0f / static_cast<float>(period)),
+        m_target(value),
+        m_value(value),
+        m_velocity(0.0f),
+        m_prev(),
+        m_started(false)
+    {
+        if (kernel == EMA_KERNEL)
+        {
+            m_kernel = kernel::EMA;
+            m_rate *= EMA_RATE;
+        }
+        else if (kernel == SPRING_KERNEL)
+        {
+            m_kernel = kernel::SPRING;
+            m_rate *= SPRING_RATE;
+        }
+    }
+
+    bool smoother::kernel_exists(const std::string& kernel) noexcept
     {
+        return kernel == LINEAR_KERNEL || kernel == EMA_KERNEL ||
+               kernel == SPRING_KERNEL;
     }
 
-    void smoother::target(float target) noexcept { m_target = target; }
+    void smoother::target(float target) noexcept
+    {
+        // NaN (no jiffies elapsed) would stick in the state forever
+        m_target = std::isnan(target) ? m_target : target;
+    }
 
-    float smoother::value(uint64_t delta) noexcept
+    float smoother::value(clock::time_point now) noexcept
     {
-        if (m_prev == m_target)
+        using namespace std::chrono;
+
+        float dt = 0.0f;
+        if (m_started)
         {
-            return m_target;
+            dt = duration<float, std::milli>(now - m_prev).count();
         }
+        m_prev = now;
+        m_started = true;
 
-        float diff = m_target - m_prev;
-        int sign = (diff > 0) - (diff < 0);
-        float step = static_cast<float>(delta) / static_cast<float>(m_period);
+        float offset = m_value - m_target;
 
-        float result = m_prev;
-        result += step * sign;
-        result = (sign > 0) ? std::min(result, m_target)
-                            : std::max(result, m_target);
-
-        m_prev = result;
+        switch (m_kernel)
+        {
+        case kernel::LINEAR:
+        {
+            // Constant slew rate
+            float step = dt * m_rate;
+            m_value -= std::clamp(offset, -step, step);
+            break;
+        }
+        case kernel::EMA:
+        {
+            m_value = m_target + offset * std::exp(-dt * m_rate);
+            break;
+        }
+        case kernel::SPRING:
+        {
+            // Critically damped spring:
+            // x(t) = (x0 + (v0 + w * x0) * t) * e^(-w * t)
+            float decay = std::exp(-dt * m_rate);
+            float term = (m_velocity + m_rate * offset) * dt;
+            m_value = m_target + (offset + term) * decay;
+            m_velocity = (m_velocity - m_rate * term) * decay;
+            break;
+        }
+        }
 
-        return result;
+        return m_value;
     }
 
 }
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <string>
 #include <cstdint>
+#include <chrono>
+
+#include "clock.h"
 
 namespace pcat
 {
@@ -11,11 +15,27 @@ namespace pcat
     class smoother
     {
     public:
+        static const std::string LINEAR_KERNEL;
+
+        static const std::string EMA_KERNEL;
+
+        static const std::string SPRING_KERNEL;
+
         /**
          * @brief Constructs an instance with specified smoothing period
-         * @param period Period of smoothing
+         * @param period Milliseconds to transition from 0 to 1
+         * @param kernel Kernel name, linear kernel is used for unknown names
+         * @param value Initial value and target
          */
-        smoother(uint64_t period) noexcept;
+        smoother(uint64_t period, const std::string& kernel,
+            float value = 0.0f) noexcept;
+
+        /**
+         * @brief Tells if the kernel exists
+         * @param kernel Kernel name
+         * @return true - if it does, false - otherwise
+         */
+        static bool kernel_exists(const std::string& kernel) noexcept;
 
         /**
          * @brief Sets current target for smoother
@@ -24,15 +44,27 @@ namespace pcat
         void target(float target) noexcept;
 
         /**
-         * @brief Retrieves smoothed value based on delta
-         * @param delta Time difference
+         * @brief Retrieves smoothed value at specified time, the first call
+         * only sets the starting time
+         * @param now Current time
          */
-        float value(uint64_t delta) noexcept;
+        float value(clock::time_point now) noexcept;
 
     private:
-        uint64_t m_period;
+        enum class kernel : uint8_t
+        {
+            LINEAR,
+            EMA,
+            SPRING,
+        };
+
+        kernel m_kernel;
+        float m_rate;
         float m_target;
-        float m_prev;
+        float m_value;
+        float m_velocity;
+        clock::time_point m_prev;
+        bool m_started;
     };
 
 }
@@ -0,0 +1,258 @@
+#include "trace.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief Appends nanoseconds as microseconds with three decimals, the unit
+ * of Chrome trace timestamps
+ */
+static void _append_us(std::string& out, int64_t ns)
+{
+    int64_t frac = ns % 1000;
+    out += std::to_string(ns / 1000);
+    out += '.';
+    out += static_cast<char>('0' + frac / 100);
+    out += static_cast<char>('0' + frac / 10 % 10);
+    out += static_cast<char>('0' + frac % 10);
+}
+
+namespace pcat
+{
+
+    trace::ring::ring() noexcept :
+        m_events(),
+        m_head(0),
+        m_tail(0),
+        m_dropped(0)
+    {
+    }
+
+    void trace::ring::push(const event& event) noexcept
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == RING_SIZE)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        m_events[head % RING_SIZE] = event;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    bool trace::ring::pop(event& event) noexcept
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        event = m_events[tail % RING_SIZE];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t trace::ring::dropped() const noexcept
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    trace::span::span(ring* ring, const char* name) noexcept :
+        m_ring(ring),
+        m_name(name),
+        m_begin(ring != nullptr ? now() : 0)
+    {
+    }
+
+    trace::span::~span() noexcept
+    {
+        if (m_ring != nullptr)
+        {
+            m_ring->push({ m_name, m_begin, now() });
+        }
+    }
+
+    trace::trace() noexcept :
+        m_fd(-1),
+        m_errno(0),
+        m_start(0),
+        m_rings(),
+        m_names(),
+        m_threads(0),
+        m_named(0),
+        m_threads_mut(),
+        m_buf(),
+        m_first(true),
+        m_flush_thread(),
+        m_done(false),
+        m_done_mut(),
+        m_done_cv(),
+        m_close_mut()
+    {
+    }
+
+    trace::~trace() noexcept { close(); }
+
+    bool trace::open(const std::string& path) noexcept
+    {
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            0644);
+        if (m_fd == -1)
+        {
+            m_errno = errno;
+            return false;
+        }
+
+        m_start = now();
+        m_buf = "[";
+        write_buf();
+        if (m_errno != 0)
+        {
+            return false;
+        }
+
+        m_flush_thread = std::thread(&trace::run, this);
+        return true;
+    }
+
+    trace::ring* trace::thread(const char* name) noexcept
+    {
+        std::lock_guard guard(m_threads_mut);
+
+        size_t index = m_threads.load(std::memory_order_relaxed);
+        if (m_fd == -1 || index == MAX_THREADS)
+        {
+            return nullptr;
+        }
+
+        m_names[index] = name;
+        m_threads.store(index + 1, std::memory_order_release);
+        return &m_rings[index];
+    }
+
+    void trace::close() noexcept
+    {
+        std::lock_guard guard(m_close_mut);
+        if (!m_flush_thread.joinable())
+        {
+            return;
+        }
+
+        m_done_mut.lock();
+        m_done = true;
+        m_done_mut.unlock();
+        m_done_cv.notify_all();
+        m_flush_thread.join();
+
+        flush();
+
+        // Shown as a global instant event at the end of the timeline
+        uint64_t dropped = 0;
+        for (const ring& ring : m_rings)
+        {
+            dropped += ring.dropped();
+        }
+        if (dropped != 0)
+        {
+            m_buf += m_first ? "\n" : ",\n";
+            m_buf += "{\"name\":\"" + std::to_string(dropped) +
+                     " events dropped\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" +
+                     std::to_string(getpid()) + ",\"tid\":0,\"ts\":";
+            _append_us(m_buf, now() - m_start);
+            m_buf += "}";
+        }
+
+        m_buf += "\n]\n";
+        write_buf();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    bool trace::io_err() const noexcept { return m_errno != 0; }
+
+    const char* trace::io_err_what() const noexcept
+    {
+        return m_errno != 0 ? std::strerror(m_errno) : "";
+    }
+
+    int64_t trace::now() noexcept
+    {
+        using namespace std::chrono;
+
+        return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void trace::run() noexcept
+    {
+        std::unique_lock lock(m_done_mut);
+        while (!m_done)
+        {
+            m_done_cv.wait_for(lock, FLUSH_PERIOD);
+
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    void trace::flush() noexcept
+    {
+        std::string pid = std::to_string(getpid());
+        size_t threads = m_threads.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < threads; i++)
+        {
+            std::string ids =
+                "\"pid\":" + pid + ",\"tid\":" + std::to_string(i + 1);
+
+            // Thread names are metadata events
+            if (i == m_named)
+            {
+                m_buf += m_first ? "\n" : ",\n";
+                m_first = false;
+                m_buf += "{\"name\":\"thread_name\",\"ph\":\"M\"," + ids +
+                         ",\"args\":{\"name\":\"" + m_names[i] + "\"}}";
+                m_named++;
+            }
+
+            event event;
+            while (m_rings[i].pop(event))
+            {
+                m_buf += m_first ? "\n" : ",\n";
+                m_first = false;
+                m_buf += "{\"name\":\"";
+                m_buf += event.name;
+                m_buf += "\",\"ph\":\"X\"," + ids + ",\"ts\":";
+                _append_us(m_buf, event.begin - m_start);
+                m_buf += ",\"dur\":";
+                _append_us(m_buf, event.end - event.begin);
+                m_buf += "}";
+            }
+        }
+
+        write_buf();
+    }
+
+    void trace::write_buf() noexcept
+    {
+        size_t off = 0;
+        while (m_errno == 0 && off < m_buf.size())
+        {
+            ssize_t n = ::write(m_fd, m_buf.data() + off, m_buf.size() - off);
+            if (n < 0 && errno != EINTR)
+            {
+                m_errno = errno;
+            }
+            off += n > 0 ? static_cast<size_t>(n) : 0;
+        }
+        m_buf.clear();
+    }
+
+}
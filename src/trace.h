@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace pcat
+{
+
+    /**
+     * @brief Records spans of every thread into lock-free per-thread rings,
+     * a background thread writes them as Chrome trace JSON
+     */
+    class trace
+    {
+    public:
+        static constexpr size_t RING_SIZE = 4096;
+
+        static constexpr size_t MAX_THREADS = 4;
+
+        static constexpr std::chrono::milliseconds FLUSH_PERIOD { 100 };
+
+        /**
+         * @brief Completed span
+         */
+        struct event
+        {
+            const char* name;
+            int64_t begin;
+            int64_t end;
+        };
+
+        /**
+         * @brief Events of a single thread, written by that thread and read
+         * by the flush thread only
+         */
+        class ring
+        {
+        public:
+            ring() noexcept;
+
+            /**
+             * @brief Adds an event, drops it if the ring is full
+             */
+            void push(const event& event) noexcept;
+
+            /**
+             * @brief Takes the oldest event
+             * @return true - if there was one, false - otherwise
+             */
+            bool pop(event& event) noexcept;
+
+            /**
+             * @brief Tells the number of events dropped
+             */
+            uint64_t dropped() const noexcept;
+
+        private:
+            std::array<event, RING_SIZE> m_events;
+            std::atomic<uint64_t> m_head;
+            std::atomic<uint64_t> m_tail;
+            std::atomic<uint64_t> m_dropped;
+        };
+
+        /**
+         * @brief Records a span from construction to destruction, does
+         * nothing for a null ring
+         */
+        class span
+        {
+        public:
+            span(ring* ring, const char* name) noexcept;
+
+            ~span() noexcept;
+
+            span(const span&) = delete;
+
+            span& operator=(const span&) = delete;
+
+        private:
+            ring* m_ring;
+            const char* m_name;
+            int64_t m_begin;
+        };
+
+        trace() noexcept;
+
+        ~trace() noexcept;
+
+        trace(const trace&) = delete;
+
+        trace& operator=(const trace&) = delete;
+
+        /**
+         * @brief Opens the trace file and starts the flush thread
+         * @param path Path to trace file
+         * @return true - on success, false - otherwise
+         */
+        bool open(const std::string& path) noexcept;
+
+        /**
+         * @brief Registers the calling thread
+         * @param name Thread name shown in the trace
+         * @return Ring of the thread, nullptr if there are too many threads
+         */
+        ring* thread(const char* name) noexcept;
+
+        /**
+         * @brief Writes the remaining events and closes the file, can be
+         * called from any thread
+         */
+        void close() noexcept;
+
+        /**
+         * @brief Tells if an IO error has happened
+         * @return true - on error, false - otherwise
+         */
+        bool io_err() const noexcept;
+
+        /**
+         * @brief Tells IO error message, if happened
+         * @return message string, if error happened, empty string - otherwise
+         */
+        const char* io_err_what() const noexcept;
+
+        /**
+         * @brief Tells the current time in trace units
+         */
+        static int64_t now() noexcept;
+
+    private:
+        int m_fd;
+        int m_errno;
+        int64_t m_start;
+        std::array<ring, MAX_THREADS> m_rings;
+        std::array<const char*, MAX_THREADS> m_names;
+        std::atomic<size_t> m_threads;
+        size_t m_named;
+        std::mutex m_threads_mut;
+        std::string m_buf;
+        bool m_first;
+        std::thread m_flush_thread;
+        bool m_done;
+        std::mutex m_done_mut;
+        std::condition_variable m_done_cv;
+        std::mutex m_close_mut;
+
+        /**
+         * @brief Writes events until closed
+         */
+        void run() noexcept;
+
+        /**
+         * @brief Moves events of every ring into the file
+         */
+        void flush() noexcept;
+
+        /**
+         * @brief Writes the buffer with write(2)
+         */
+        void write_buf() noexcept;
+    };
+
+}